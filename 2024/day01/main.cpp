@@ -1,25 +1,19 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
-#include <sstream>
 #include <string>
 #include <cctype>
+#include <algorithm>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
+#include "../../include/radix_sort.hpp"
+#include "../../include/bench.hpp"
+#include "../../include/int_scanner.hpp"
+#include "../../include/flat_count_map.hpp"
 
-//split a string by whitespace, handles multiple consecutive spaces
-std::vector<std::string> splitByWhitespace(std::string s)
-{
-  std::vector<std::string> words;
-  std::istringstream iss(s);
-  std::string word;
-
-  while (iss >> word) 
-  {
-    words.push_back(word);
-  }
-  return words;
-}
-
-// quick sort implementation
+// quick sort implementation, kept only as a baseline for --bench
+// (last-element pivot: quadratic and deeply recursive on sorted input)
 void quickSort(std::vector<int> &arr, int left, int right) {
   if (left < right) {
     int pivot = arr[right];
@@ -38,47 +32,144 @@ void quickSort(std::vector<int> &arr, int left, int right) {
   }
 }
 
-int main() {
-  std::ifstream input("input.txt");
-  std::string line;
+// sum of left[i] * countOf(left[i]) with the left list scanned in parallel chunks
+template <typename CountFn>
+long long scanLeft(const std::vector<int> &left, unsigned threads, CountFn countOf)
+{
+  threads = std::clamp<unsigned>(left.size() / radix_sort_min_chunk, 1, threads);
+  std::vector<long long> partial(threads, 0);
+  parallel_for_chunks(left.size(), threads, [&](unsigned t, size_t begin, size_t end) {
+    long long acc = 0;
+    for (size_t i = begin; i < end; ++i) {
+      acc += static_cast<long long>(left[i]) * countOf(left[i]);
+    }
+    partial[t] = acc;
+  });
+
+  long long score = 0;
+  for (long long value : partial) {
+    score += value;
+  }
+  return score;
+}
+
+// Part 2 without sorting: score = sum of left id * times it appears in right
+// O(n) using a dense count array when the right ids span a bounded range, a hash table otherwise
+long long similarityScore(const std::vector<int> &left, const std::vector<int> &right, unsigned threads)
+{
+  if (left.empty() || right.empty()) {
+    return 0;
+  }
+
+  const auto [minIt, maxIt] = std::minmax_element(right.begin(), right.end());
+  const int minId = *minIt;
+  const int maxId = *maxIt;
+  const long long range = static_cast<long long>(maxId) - minId + 1;
+  // allow a dense table of up to 4 counters per id (or 1M counters) before switching to hashing
+  const long long denseLimit = std::max<long long>(1 << 20, 4 * static_cast<long long>(right.size()));
+
+  if (range <= denseLimit) {
+    std::vector<uint32_t> counts(range, 0);
+    for (int id : right) {
+      ++counts[id - minId];
+    }
+    return scanLeft(left, threads, [&](int id) -> uint32_t {
+      return id < minId || id > maxId ? 0 : counts[id - minId];
+    });
+  }
+
+  flat_count_map<int, uint32_t> table(right.size());
+  for (int id : right) {
+    table.add(id);
+  }
+  return scanLeft(left, threads, [&](int id) { return table.count(id); });
+}
+
+// compare radix_sort against quickSort and std::sort on sorted, reverse-sorted and random inputs
+void runBenchmark(size_t n)
+{
+  // quickSort recurses n levels deep on sorted input, so only run it where it can finish
+  const size_t quickSortLimit = 1 << 15;
+  std::mt19937 rng(2024);
+  std::uniform_int_distribution<int> dist(10000, 99999);
+
+  std::vector<int> random(n);
+  for (auto &value : random) {
+    value = dist(rng);
+  }
+  std::vector<int> sorted = random;
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<int> reversed(sorted.rbegin(), sorted.rend());
+
+  const std::pair<const char *, const std::vector<int> *> inputs[] = {
+    { "sorted", &sorted }, { "reverse", &reversed }, { "random", &random }
+  };
+  std::cout << "n = " << n << ", threads = " << default_thread_count() << std::endl;
+  for (const auto &[name, source] : inputs) {
+    std::vector<int> work;
+    auto timed = [&](auto &&sortFn) {
+      return measure_ms([&] {
+        work = *source;
+        sortFn(work);
+      });
+    };
+
+    std::cout << name << ":" << std::endl;
+    if (n <= quickSortLimit) {
+      std::cout << "  quickSort         " << timed([](std::vector<int> &v) { quickSort(v, 0, v.size() - 1); })
+                << " ms" << std::endl;
+    } else {
+      std::cout << "  quickSort         skipped (n > " << quickSortLimit << ")" << std::endl;
+    }
+    std::cout << "  std::sort         " << timed([](std::vector<int> &v) { std::sort(v.begin(), v.end()); })
+              << " ms" << std::endl;
+    std::cout << "  radix_sort        " << timed([](std::vector<int> &v) { radix_sort(std::span<int>(v)); })
+              << " ms" << std::endl;
+    std::cout << "  radix_sort (mt)   "
+              << timed([](std::vector<int> &v) { radix_sort(std::span<int>(v), default_thread_count()); }) << " ms"
+              << std::endl;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  // usage: main [--bench [n] | --part2]
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    runBenchmark(argc > 2 ? std::stoul(argv[2]) : 1 << 15);
+    return 0;
+  }
+  const bool onlyPart2 = argc > 1 && std::string(argv[1]) == "--part2";
+
+  const std::string content = read_file("input.txt");
   std::vector<int> left;
   std::vector<int> right;
-  while (std::getline(input, line)) {
-    std::vector<std::string> parts = splitByWhitespace(line);
-    if (parts.size() == 2) {
-      left.push_back(std::stoi(parts[0]));
-      right.push_back(std::stoi(parts[1]));
+  int_scanner scanner(content);
+  do {
+    int a = 0, b = 0, extra = 0;
+    if (scanner.next(a) && scanner.next(b) && !scanner.next(extra)) {
+      left.push_back(a);
+      right.push_back(b);
     }
+  } while (scanner.next_line());
+
+  /* Part 2 */
+  /* score = num_left * times of appearance in right, needs no sorting */
+  long long similarity_score = similarityScore(left, right, default_thread_count());
+  if (onlyPart2) {
+    std::cout << "Similarity score: " << similarity_score << std::endl;
+    return 0;
   }
-  input.close();
 
   // sort left and right vectors for next steps
-  quickSort(left, 0, left.size() - 1);
-  quickSort(right, 0, right.size() - 1);
+  radix_sort(std::span<int>(left), default_thread_count());
+  radix_sort(std::span<int>(right), default_thread_count());
 
   /* Part 1 */
 
-  int sum = 0;
+  long long sum = 0;
   for (size_t i = 0; i < left.size(); ++i) {
-    sum += std::abs(left[i] - right[i]);
+    sum += std::abs(static_cast<long long>(left[i]) - right[i]);
   }
   std::cout << "Sum of distances: " << sum << std::endl;
-
-  /* Part 2 */
-  /* score = num_left * times of appearance in right */
-  int similarity_score = 0;
-  size_t i = 0, j = 0;
-  while (i < left.size() && j < right.size()) {
-    if (left[i] < right[j]) {
-      i++;
-    } else if (left[i] > right[j]) {
-      j++;
-    } else {
-      // found a match
-      similarity_score += left[i];
-      j++;
-    }
-  }
   std::cout << "Similarity score: " << similarity_score << std::endl;
   return 0;
 }
\ No newline at end of file
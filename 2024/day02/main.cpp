@@ -5,8 +5,34 @@
 #include <string>
 #include <cctype>
 #include <cmath>
+#include <random>
+#include <span>
+#include "../../include/int_scanner.hpp"
+#include "../../include/bench.hpp"
+#include "../../include/parallel.hpp"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// all reports in CSR layout: report i is levels[offsets[i], offsets[i + 1])
+struct ReportTable
+{
+  std::vector<int> levels;
+  std::vector<size_t> offsets{ 0 };
+
+  size_t size() const
+  {
+    return offsets.size() - 1;
+  }
+
+  std::span<const int> report(size_t i) const
+  {
+    return std::span<const int>(levels).subspan(offsets[i], offsets[i + 1] - offsets[i]);
+  }
+};
 
 // split a string by whitespace, handles multiple consecutive spaces
+// only used as the baseline parser in --bench
 std::vector<std::string> splitByWhitespace(std::string s)
 {
   std::vector<std::string> words;
@@ -20,7 +46,7 @@ std::vector<std::string> splitByWhitespace(std::string s)
   return words;
 }
 
-bool isValidReport(const std::vector<int> &levels)
+bool isValidReportScalar(std::span<const int> levels)
 {
   /*cond1: report is ascend or descend */
   /*cond2: Any two adjacent levels differ by at least one and at most three */
@@ -45,14 +71,97 @@ bool isValidReport(const std::vector<int> &levels)
   return isAscending || isDescending;
 }
 
-bool isValidReportWithOneRemoval(const std::vector<int> &levels)
+bool isValidReport(std::span<const int> levels)
+{
+#ifdef __AVX2__
+  /* same conditions, 8 adjacent differences per instruction: */
+  /* every difference in [1, 3] (ascending) or every difference in [-3, -1] (descending) */
+  const size_t n = levels.size();
+  if (n < 9)
+  {
+    return isValidReportScalar(levels);
+  }
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i four = _mm256_set1_epi32(4);
+  const __m256i minusFour = _mm256_set1_epi32(-4);
+  __m256i ascending = _mm256_set1_epi32(-1);
+  __m256i descending = ascending;
+  size_t i = 0;
+  for (; i + 8 < n; i += 8)
+  {
+    const __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(levels.data() + i));
+    const __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(levels.data() + i + 1));
+    const __m256i diff = _mm256_sub_epi32(next, cur);
+    const __m256i stepUp = _mm256_and_si256(_mm256_cmpgt_epi32(diff, zero), _mm256_cmpgt_epi32(four, diff));
+    const __m256i stepDown = _mm256_and_si256(_mm256_cmpgt_epi32(zero, diff), _mm256_cmpgt_epi32(diff, minusFour));
+    ascending = _mm256_and_si256(ascending, stepUp);
+    descending = _mm256_and_si256(descending, stepDown);
+    if (_mm256_testz_si256(_mm256_or_si256(ascending, descending), _mm256_or_si256(ascending, descending)))
+    {
+      return false;
+    }
+  }
+  bool isAscending = _mm256_movemask_epi8(ascending) == -1;
+  bool isDescending = _mm256_movemask_epi8(descending) == -1;
+  for (; i + 1 < n; ++i)
+  {
+    const int diff = levels[i + 1] - levels[i];
+    isAscending = isAscending && diff >= 1 && diff <= 3;
+    isDescending = isDescending && diff >= -3 && diff <= -1;
+  }
+  return isAscending || isDescending;
+#else
+  return isValidReportScalar(levels);
+#endif
+}
+
+/* step from a to b is safe in the given direction (+1 ascending, -1 descending) */
+inline bool isSafeStep(int a, int b, int direction)
+{
+  int diff = (b - a) * direction;
+  return diff >= 1 && diff <= 3;
+}
+
+/* report is valid in the given direction once levels[skip] is ignored, O(n) without copying */
+bool isValidSkipping(std::span<const int> levels, size_t skip, int direction)
+{
+  size_t prev = skip == 0 ? 1 : 0;
+  for (size_t i = prev + 1; i < levels.size(); ++i)
+  {
+    if (i == skip)
+    {
+      continue;
+    }
+    if (!isSafeStep(levels[prev], levels[i], direction))
+    {
+      return false;
+    }
+    prev = i;
+  }
+  return true;
+}
+
+bool isValidReportWithOneRemoval(std::span<const int> levels)
 {
   /* Check if we can remove one level to make the report valid */
-  for (size_t i = 0; i < levels.size(); ++i)
+  /* For each direction only the first violating pair (i, i + 1) matters: */
+  /* any fix has to remove one of those two levels, so at most two O(n) rescans per direction */
+  if (levels.size() <= 2)
+  {
+    return true;
+  }
+  for (int direction : {1, -1})
   {
-    std::vector<int> modifiedLevels = levels;
-    modifiedLevels.erase(modifiedLevels.begin() + i);
-    if (isValidReport(modifiedLevels))
+    size_t bad = 0;
+    while (bad + 1 < levels.size() && isSafeStep(levels[bad], levels[bad + 1], direction))
+    {
+      ++bad;
+    }
+    if (bad + 1 == levels.size())
+    {
+      return true; // already valid
+    }
+    if (isValidSkipping(levels, bad, direction) || isValidSkipping(levels, bad + 1, direction))
     {
       return true;
     }
@@ -60,45 +169,133 @@ bool isValidReportWithOneRemoval(const std::vector<int> &levels)
   return false;
 }
 
-int main()
+/* count reports accepted by isValid, report ranges split across threads */
+template <typename Predicate>
+int countValidReports(const ReportTable &reports, Predicate isValid, unsigned threads)
 {
-  /* one report per line. Each report is a list of numbers called levels that are separated by spaces. */
-  std::ifstream input("input.txt");
-  std::string line;
-  std::vector<int> levels;
-  std::vector<std::vector<int>> reports;
+  threads = std::clamp<unsigned>(reports.levels.size() / (1 << 16), 1, threads);
+  std::vector<int> partial(threads, 0);
+  parallel_for_chunks(reports.size(), threads, [&](unsigned t, size_t begin, size_t end) {
+    int count = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+      count += isValid(reports.report(i)) ? 1 : 0;
+    }
+    partial[t] = count;
+  });
 
-  while (std::getline(input, line))
+  int total = 0;
+  for (int count : partial)
   {
-    std::vector<std::string> parts = splitByWhitespace(line);
-    for (const auto &part : parts)
+    total += count;
+  }
+  return total;
+}
+
+// parse-only throughput: splitByWhitespace + stoi vs int_scanner over the same buffer
+void runParseBenchmark(size_t lineCount)
+{
+  std::mt19937 rng(2024);
+  std::uniform_int_distribution<int> lengthDist(5, 8);
+  std::uniform_int_distribution<int> levelDist(1, 99);
+  std::string content;
+  for (size_t i = 0; i < lineCount; ++i)
+  {
+    const int length = lengthDist(rng);
+    for (int j = 0; j < length; ++j)
     {
-      levels.push_back(std::stoi(part));
+      content += std::to_string(levelDist(rng));
+      content += j + 1 < length ? ' ' : '\n';
     }
-    reports.push_back(levels);
-    levels.clear();
   }
-  input.close();
+  const double megabytes = content.size() / (1024.0 * 1024.0);
 
-  /* Part 1 */
-  int validReportsCount = 0;
-  for (const auto &report : reports)
+  long long checksum = 0;
+  const double splitMs = measure_ms([&] {
+    std::istringstream input(content);
+    std::string line;
+    while (std::getline(input, line))
+    {
+      for (const auto &part : splitByWhitespace(line))
+      {
+        checksum += std::stoi(part);
+      }
+    }
+  });
+  const double scanMs = measure_ms([&] {
+    int_scanner scanner(content);
+    do
+    {
+      int level = 0;
+      while (scanner.next(level))
+      {
+        checksum += level;
+      }
+    } while (scanner.next_line());
+  });
+
+  std::cout << "input: " << lineCount << " lines, " << megabytes << " MB (checksum " << checksum << ")" << std::endl;
+  std::cout << "splitByWhitespace + stoi: " << splitMs << " ms, " << megabytes / (splitMs / 1000.0) << " MB/s"
+            << std::endl;
+  std::cout << "int_scanner:              " << scanMs << " ms, " << megabytes / (scanMs / 1000.0) << " MB/s"
+            << std::endl;
+
+  // single-core validation throughput on long ascending reports (the worst case: nothing exits early)
+  ReportTable reports;
+  for (size_t i = 0; i < lineCount / 100 + 1; ++i)
   {
-    if (isValidReport(report))
+    int level = 0;
+    for (int j = 0; j < 1000; ++j)
     {
-      validReportsCount++;
+      level += 1 + j % 3;
+      reports.levels.push_back(level);
     }
+    reports.offsets.push_back(reports.levels.size());
   }
+  int valid = 0;
+  const double millionLevels = reports.levels.size() / 1e6;
+  const double scalarMs = measure_ms([&] { valid = countValidReports(reports, isValidReportScalar, 1); });
+  const double simdMs = measure_ms([&] {
+    valid = countValidReports(reports, [](std::span<const int> levels) { return isValidReport(levels); }, 1);
+  });
+  std::cout << "validate " << reports.levels.size() << " levels (" << valid << " valid reports):" << std::endl;
+  std::cout << "scalar:                   " << millionLevels / (scalarMs / 1000.0) << " M levels/s" << std::endl;
+  std::cout << "isValidReport:            " << millionLevels / (simdMs / 1000.0) << " M levels/s" << std::endl;
+}
 
-  /* Part 2 */
-  int validReportsWithOneRemovalCount = 0;
-  for (const auto &report : reports)
+int main(int argc, char *argv[])
+{
+  // usage: main [--bench [lines]]
+  if (argc > 1 && std::string(argv[1]) == "--bench")
   {
-    if (isValidReportWithOneRemoval(report))
+    runParseBenchmark(argc > 2 ? std::stoul(argv[2]) : 1000000);
+    return 0;
+  }
+
+  /* one report per line. Each report is a list of numbers called levels that are separated by spaces. */
+  const std::string content = read_file("input.txt");
+  ReportTable reports;
+
+  int_scanner scanner(content);
+  do
+  {
+    int level = 0;
+    while (scanner.next(level))
     {
-      validReportsWithOneRemovalCount++;
+      reports.levels.push_back(level);
     }
-  }
+    if (reports.levels.size() != reports.offsets.back())
+    {
+      reports.offsets.push_back(reports.levels.size());
+    }
+  } while (scanner.next_line());
+
+  /* Part 1 */
+  int validReportsCount = countValidReports(
+      reports, [](std::span<const int> levels) { return isValidReport(levels); }, default_thread_count());
+
+  /* Part 2 */
+  int validReportsWithOneRemovalCount = countValidReports(reports, isValidReportWithOneRemoval, default_thread_count());
 
   std::cout << "Number of valid reports: " << validReportsCount << std::endl;
   std::cout << "Number of valid reports with one removal: " << validReportsWithOneRemovalCount << std::endl;
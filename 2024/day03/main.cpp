@@ -1,51 +1,191 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <regex>
+#include <string_view>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include "../../include/parallel.hpp"
+#include "../../include/bench.hpp"
 
-int main() {
+// Token recognised by the scanner
+enum class TokenKind {
+    None,
+    Mul,
+    Do,
+    Dont
+};
+
+struct Token {
+    TokenKind kind = TokenKind::None;
+    size_t length = 0;      // characters consumed by the token
+    long long product = 0;  // a * b for mul(a,b)
+};
+
+// Parse 1-3 digits at text[pos], advancing pos; false if there is no digit
+bool parseOperand(std::string_view text, size_t &pos, long long &value) {
+    size_t digits = 0;
+    value = 0;
+    while (digits < 3 && pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        value = value * 10 + (text[pos] - '0');
+        ++pos;
+        ++digits;
+    }
+    return digits > 0;
+}
+
+// Try to match mul(a,b), do() or don't() starting exactly at text[pos]
+Token matchToken(std::string_view text, size_t pos) {
+    const std::string_view rest = text.substr(pos);
+    if (rest.starts_with("mul(")) {
+        size_t cursor = pos + 4;
+        long long a = 0, b = 0;
+        if (parseOperand(text, cursor, a) && cursor < text.size() && text[cursor] == ',' &&
+            parseOperand(text, ++cursor, b) && cursor < text.size() && text[cursor] == ')') {
+            return { TokenKind::Mul, cursor + 1 - pos, a * b };
+        }
+    } else if (rest.starts_with("do()")) {
+        return { TokenKind::Do, 4, 0 };
+    } else if (rest.starts_with("don't()")) {
+        return { TokenKind::Dont, 7, 0 };
+    }
+    return {};
+}
+
+// Call onToken for every token that starts in [begin, end) of text.
+// A token may run past end: the chunk that owns its first character matches it whole.
+// Candidate starts ('m' and 'd') are located with memchr; everything else is skipped in bulk.
+template <typename OnToken>
+void forEachToken(std::string_view text, size_t begin, size_t end, OnToken onToken) {
+    const char *base = text.data();
+    const char *stop = base + end;
+
+    auto find = [&](const char *from, char ch) {
+        const void *hit = from < stop ? std::memchr(from, ch, stop - from) : nullptr;
+        return hit ? static_cast<const char *>(hit) : stop;
+    };
+
+    const char *nextM = find(base + begin, 'm');
+    const char *nextD = find(base + begin, 'd');
+    while (nextM != stop || nextD != stop) {
+        const char *candidate = std::min(nextM, nextD);
+        Token token = matchToken(text, candidate - base);
+        if (token.kind != TokenKind::None) {
+            onToken(token);
+        }
+
+        // matches never overlap; a failed candidate only rules out its own first character
+        const char *resume = candidate + std::max<size_t>(token.length, 1);
+        if (nextM < resume) {
+            nextM = find(resume, 'm');
+        }
+        if (nextD < resume) {
+            nextD = find(resume, 'd');
+        }
+    }
+}
+
+// Result of a chunk for both possible starting states, indexed by the enable state at chunk start.
+// No token can start inside another matched token (none of them contains 'm' or 'd' after its
+// first character), so chunks can be scanned independently and folded left to right.
+struct ChunkSummary {
+    long long total[2] = { 0, 0 };      // sum of enabled products
+    bool endEnabled[2] = { false, true }; // enable state after the chunk
+};
+
+ChunkSummary summarizeChunk(std::string_view text, size_t begin, size_t end) {
+    ChunkSummary summary;
+    forEachToken(text, begin, end, [&](const Token &token) {
+        for (int start = 0; start < 2; ++start) {
+            switch (token.kind) {
+            case TokenKind::Mul:
+                if (summary.endEnabled[start]) {
+                    summary.total[start] += token.product;
+                }
+                break;
+            case TokenKind::Do:
+                summary.endEnabled[start] = true;
+                break;
+            case TokenKind::Dont:
+                summary.endEnabled[start] = false;
+                break;
+            case TokenKind::None:
+                break;
+            }
+        }
+    });
+    return summary;
+}
+
+// Scan text on up to `threads` threads, then fold the chunk summaries with the running enable
+// state. Gives exactly the same total as a single sequential pass starting enabled.
+long long evaluateInstructions(std::string_view text, unsigned threads) {
+    const size_t minChunk = 1 << 20;
+    threads = static_cast<unsigned>(std::clamp<size_t>(text.size() / minChunk, 1, std::max(1u, threads)));
+
+    std::vector<ChunkSummary> summaries(threads);
+    parallel_for_chunks(text.size(), threads, [&](unsigned t, size_t begin, size_t end) {
+        summaries[t] = summarizeChunk(text, begin, end);
+    });
+
+    long long total = 0;
+    bool enabled = true;
+    for (const ChunkSummary &summary : summaries) {
+        total += summary.total[enabled];
+        enabled = summary.endEnabled[enabled];
+    }
+    return total;
+}
+
+// Evaluate a synthetic dump (the input repeated up to `megabytes`) on 1, 2, 4, ... threads
+void runScalingBenchmark(const std::string &content, size_t megabytes) {
+    std::string dump;
+    dump.reserve(megabytes << 20);
+    while (dump.size() + content.size() <= (megabytes << 20)) {
+        dump += content;
+    }
+
+    const long long expected = evaluateInstructions(dump, 1);
+    double singleMs = 0;
+    std::cout << "dump: " << dump.size() / (1024.0 * 1024.0) << " MB, total " << expected << std::endl;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, default_thread_count())) {
+        long long total = 0;
+        const double ms = measure_ms([&] { total = evaluateInstructions(dump, threads); });
+        if (threads == 1) {
+            singleMs = ms;
+        }
+        std::cout << threads << " threads: " << ms << " ms, " << dump.size() / (1024.0 * 1024.0) / (ms / 1000.0)
+                  << " MB/s, speedup " << singleMs / ms << (total == expected ? "" : " (MISMATCH)") << std::endl;
+        if (threads == default_thread_count()) {
+            break;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // usage: main [--bench [megabytes]]
     // Read the input file
     std::ifstream file("input.txt");
     if (!file.is_open()) {
         std::cerr << "Error: Could not open input.txt" << std::endl;
         return 1;
     }
-    
-    std::string content;
-    std::string line;
-    
-    // Read entire file content
-    while (std::getline(file, line)) {
-        content += line;
-    }
+
+    // Read entire file content; lines are joined without separators,
+    // so tokens may continue across line breaks
+    std::string content{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
     file.close();
-      // Regex pattern to match mul(num1,num2), do(), and don't()
-    std::regex pattern(R"(mul\((\d+),(\d+)\)|do\(\)|don't\(\))");
-    std::sregex_iterator iter(content.begin(), content.end(), pattern);
-    std::sregex_iterator end;
-    
-    long long total = 0;
-    bool enabled = true; 
-    
-    while (iter != end) {
-        std::smatch match = *iter;
-        std::string matched_text = match[0].str();
-        
-        if (matched_text == "do()") {
-            enabled = true;
-        }
-        else if (matched_text == "don't()") {
-            enabled = false;  
-        }
-        else if (matched_text.substr(0, 3) == "mul" && enabled) {
-            int num1 = std::stoi(match[1].str());
-            int num2 = std::stoi(match[2].str());
-            total += num1 * num2;
-        }
-        ++iter;
+    content.erase(std::remove(content.begin(), content.end(), '\n'), content.end());
+
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runScalingBenchmark(content, argc > 2 ? std::stoul(argv[2]) : 256);
+        return 0;
     }
-    
+
+    long long total = evaluateInstructions(content, default_thread_count());
+
     std::cout << "Total sum: " << total << std::endl;
-    
+
     return 0;
-}
\ No newline at end of file
+}
@@ -2,19 +2,92 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 
 using namespace std;
 
 /**
- * @brief 对输入网格进行 8 个方向的单词搜索 单词可以互相重叠
- * @param grid 输入的二维字符数组
- * @param word 要搜索的单词
- * @param row 起始行索引
- * @param col 起始列索引
+ * 位平面: 网格中某个字母出现位置的位图
+ * 每行占 wordsPerRow 个 uint64_t, 第 c 列对应第 c / 64 个字的第 c % 64 位, 超出列数的填充位恒为 0
+ */
+struct BitPlane {
+    int rows = 0;
+    int wordsPerRow = 0;
+    vector<uint64_t> bits;
+
+    const uint64_t* row(int r) const {
+        return bits.data() + static_cast<size_t>(r) * wordsPerRow;
+    }
+};
+
+BitPlane buildPlane(const vector<string>& grid, int cols, char letter) {
+    BitPlane plane;
+    plane.rows = grid.size();
+    plane.wordsPerRow = (cols + 63) / 64;
+    plane.bits.assign(static_cast<size_t>(plane.rows) * plane.wordsPerRow, 0);
+    for (int r = 0; r < plane.rows; ++r) {
+        uint64_t* row = plane.bits.data() + static_cast<size_t>(r) * plane.wordsPerRow;
+        for (int c = 0; c < static_cast<int>(grid[r].size()); ++c) {
+            if (grid[r][c] == letter) {
+                row[c / 64] |= uint64_t{1} << (c % 64);
+            }
+        }
+    }
+    return plane;
+}
+
+/**
+ * @brief 整行按列平移: dst 第 c 位 = src 第 c + shift 位, 越界补 0
+ */
+void shiftRow(const uint64_t* src, int words, int shift, uint64_t* dst) {
+    const int wordShift = shift >= 0 ? shift / 64 : -((-shift + 63) / 64);
+    const int bitShift = shift - wordShift * 64;
+    auto word = [&](int j) -> uint64_t { return j >= 0 && j < words ? src[j] : 0; };
+    for (int i = 0; i < words; ++i) {
+        const int j = i + wordShift;
+        dst[i] = bitShift == 0 ? word(j) : (word(j) >> bitShift) | (word(j + 1) << (64 - bitShift));
+    }
+}
+
+/**
+ * 每个字母一个位平面, 按需构建
+ */
+class LetterPlanes {
+public:
+    explicit LetterPlanes(const vector<string>& grid) : m_grid(grid) {
+        for (const auto& line : grid) {
+            m_cols = max(m_cols, static_cast<int>(line.size()));
+        }
+    }
+
+    const BitPlane& plane(char letter) {
+        auto& slot = m_planes[static_cast<unsigned char>(letter)];
+        if (slot.bits.empty()) {
+            slot = buildPlane(m_grid, m_cols, letter);
+        }
+        return slot;
+    }
+
+    int rows() const { return m_grid.size(); }
+    int wordsPerRow() const { return (m_cols + 63) / 64; }
+
+private:
+    const vector<string>& m_grid;
+    int m_cols = 0;
+    array<BitPlane, 256> m_planes;
+};
+
+/**
+ * @brief 位并行的 8 方向单词搜索 单词可以互相重叠
+ * 对每个方向 (dRow, dCol) 和每个起始行 r: 第 k 个字母的位平面取第 r + k * dRow 行并平移 k * dCol 列,
+ * 全部按位与之后, 置位的列就是以 (r, c) 为起点的匹配, 每次运算处理 64 个格子
  * @return 匹配到的单词数量
  */
-int searchWord(const vector<string>& grid, const string& word, int row, int col) {
-    int directions[8][2] = {
+long long countWord(LetterPlanes& planes, const string& word) {
+    const int directions[8][2] = {
         {0, 1},   // 右
         {1, 1},   // 右下
         {1, 0},   // 下
@@ -24,67 +97,214 @@ int searchWord(const vector<string>& grid, const string& word, int row, int col)
         {-1, 0},  // 上
         {-1, 1}   // 右上
     };
-    int rows = grid.size();
-    int cols = grid[0].size();
-    int wordLength = word.length();
-    int matchCount = 0;
-    for (int direction = 0; direction < 8; ++direction) {
-        int dRow = directions[direction][0];
-        int dCol = directions[direction][1];
-        int r = row, c = col;
-        int k;
-        
-        // 检查当前方向是否匹配单词
-        for (k = 0; k < wordLength; ++k) {
-            if (r < 0 || r >= rows || c < 0 || c >= cols || grid[r][c] != word[k]) {
-                break;
+    const int rows = planes.rows();
+    const int words = planes.wordsPerRow();
+    const int wordLength = word.length();
+    if (wordLength == 0 || rows == 0) {
+        return 0;
+    }
+
+    vector<const BitPlane*> letters;
+    for (char ch : word) {
+        letters.push_back(&planes.plane(ch));
+    }
+
+    vector<uint64_t> acc(words), shifted(words);
+    long long matchCount = 0;
+    for (const auto& direction : directions) {
+        const int dRow = direction[0];
+        const int dCol = direction[1];
+        for (int r = 0; r < rows; ++r) {
+            const int lastRow = r + (wordLength - 1) * dRow;
+            if (lastRow < 0 || lastRow >= rows) {
+                continue;
+            }
+            copy(letters[0]->row(r), letters[0]->row(r) + words, acc.begin());
+            for (int k = 1; k < wordLength; ++k) {
+                shiftRow(letters[k]->row(r + k * dRow), words, k * dCol, shifted.data());
+                for (int i = 0; i < words; ++i) {
+                    acc[i] &= shifted[i];
+                }
+            }
+            for (uint64_t bits : acc) {
+                matchCount += popcount(bits);
             }
-            r += dRow;
-            c += dCol;
-        }
-        
-        if (k == wordLength) {
-            matchCount++;
         }
     }
     return matchCount;
 }
 
 /**
- * @brief 对输入网格进行 形成X-形的单词搜索
- * @param grid 输入的二维字符数组
- * @param word 要搜索的单词
- * @param row 起始行索引
- * @param col 起始列索引
- * @return bool 是否找到形成X-形的单词
+ * @brief 位并行的 X-形单词搜索 (单词长度为 3, 中心为 word[1])
+ * 两条对角线都必须形成 word 或其反向: 左上/右下 与 右上/左下 分别是一头一尾
+ * @return 形成X-形的数量
  */
-int searchWordX(const vector<string>& grid, const string& word, int row, int col) {
-    int rows = grid.size();
-    int cols = grid[0].size();
-    int wordLength = word.length();
-    
-    // 检查是否可以形成X-形
-    if (wordLength < 3 || row < 1 || row >= rows - 1 || col < 1 || col >= cols - 1) {
+long long countWordX(LetterPlanes& planes, const string& word) {
+    const int rows = planes.rows();
+    const int words = planes.wordsPerRow();
+    if (word.length() != 3 || rows < 3) {
         return 0;
     }
-    
-    // 检查中心字符
-    if (grid[row][col] != word[1]) {
-        return 0;
+
+    const BitPlane& head = planes.plane(word[0]);
+    const BitPlane& center = planes.plane(word[1]);
+    const BitPlane& tail = planes.plane(word[2]);
+
+    vector<uint64_t> upLeftHead(words), upLeftTail(words), upRightHead(words), upRightTail(words);
+    vector<uint64_t> downLeftHead(words), downLeftTail(words), downRightHead(words), downRightTail(words);
+    long long matchCount = 0;
+    for (int r = 1; r < rows - 1; ++r) {
+        shiftRow(head.row(r - 1), words, -1, upLeftHead.data());
+        shiftRow(tail.row(r - 1), words, -1, upLeftTail.data());
+        shiftRow(head.row(r - 1), words, 1, upRightHead.data());
+        shiftRow(tail.row(r - 1), words, 1, upRightTail.data());
+        shiftRow(head.row(r + 1), words, -1, downLeftHead.data());
+        shiftRow(tail.row(r + 1), words, -1, downLeftTail.data());
+        shiftRow(head.row(r + 1), words, 1, downRightHead.data());
+        shiftRow(tail.row(r + 1), words, 1, downRightTail.data());
+        const uint64_t* middle = center.row(r);
+        for (int i = 0; i < words; ++i) {
+            const uint64_t diagonal = (upLeftHead[i] & downRightTail[i]) | (upLeftTail[i] & downRightHead[i]);
+            const uint64_t antiDiagonal = (upRightHead[i] & downLeftTail[i]) | (upRightTail[i] & downLeftHead[i]);
+            matchCount += popcount(middle[i] & diagonal & antiDiagonal);
+        }
     }
-    
-    // 检查对角线方向的字符组合
-    // 两个对角线方向都必须形成"MAS"或"SAM" 即 左上是头或尾 右下是尾或头
-    return ((grid[row - 1][col - 1] == word[0] && grid[row + 1][col + 1] == word[2]) ||
-            (grid[row - 1][col - 1] == word[2] && grid[row + 1][col + 1] == word[0])) &&
-           ((grid[row - 1][col + 1] == word[0] && grid[row + 1][col - 1] == word[2]) ||
-            (grid[row - 1][col + 1] == word[2] && grid[row + 1][col - 1] == word[0]));
+    return matchCount;
 }
 
+/**
+ * Aho-Corasick 自动机: 把整个词表编译成一张确定性转移表
+ * 字母表压缩为词表中出现过的字符 (编号 1..k), 其余字符编号 0, 在任何状态下都回到根
+ */
+class WordAutomaton {
+public:
+    explicit WordAutomaton(const vector<string>& dictionary) {
+        for (const auto& word : dictionary) {
+            for (char ch : word) {
+                auto& code = m_codes[static_cast<unsigned char>(ch)];
+                if (code == 0) {
+                    code = ++m_alphabet;
+                }
+            }
+        }
+        ++m_alphabet; // 编号 0 也占一列
+
+        /* 1. 构建 trie */
+        newState();
+        for (const auto& word : dictionary) {
+            int state = 0;
+            for (char ch : word) {
+                const size_t edge = static_cast<size_t>(state) * m_alphabet + code(ch);
+                if (m_delta[edge] == 0) {
+                    const int child = newState(); // 会扩容 m_delta, 不能先取引用
+                    m_delta[edge] = child;
+                }
+                state = m_delta[edge];
+            }
+            m_terminal.push_back(word.empty() ? -1 : state);
+        }
+
+        /* 2. BFS 计算失败链接, 同时把缺失的转移补全为 DFA */
+        m_order.push_back(0);
+        for (size_t head = 0; head < m_order.size(); ++head) {
+            const int state = m_order[head];
+            for (int c = 0; c < m_alphabet; ++c) {
+                int& next = m_delta[static_cast<size_t>(state) * m_alphabet + c];
+                const int fallback = state == 0 ? 0 : m_delta[static_cast<size_t>(m_fail[state]) * m_alphabet + c];
+                if (next == 0 || c == 0) {
+                    next = c == 0 ? 0 : fallback;
+                } else {
+                    m_fail[next] = fallback;
+                    m_order.push_back(next);
+                }
+            }
+        }
+    }
+
+    int code(char ch) const { return m_codes[static_cast<unsigned char>(ch)]; }
+    int step(int state, char ch) const { return m_delta[static_cast<size_t>(state) * m_alphabet + code(ch)]; }
+    size_t stateCount() const { return m_fail.size(); }
+
+    /**
+     * @brief 把每个状态被访问的次数沿失败链接累加, 得到每个单词的出现次数
+     */
+    vector<long long> collect(vector<long long> hits) const {
+        for (size_t i = m_order.size(); i-- > 1;) {
+            hits[m_fail[m_order[i]]] += hits[m_order[i]];
+        }
+        vector<long long> counts;
+        for (int terminal : m_terminal) {
+            counts.push_back(terminal < 0 ? 0 : hits[terminal]);
+        }
+        return counts;
+    }
+
+private:
+    int newState() {
+        m_delta.resize(m_delta.size() + m_alphabet, 0);
+        m_fail.push_back(0);
+        return m_fail.size() - 1;
+    }
+
+    array<int, 256> m_codes{};
+    int m_alphabet = 0;
+    vector<int> m_delta;    // 转移表, 行为状态, 列为字符编号
+    vector<int> m_fail;     // 失败链接
+    vector<int> m_order;    // BFS 顺序
+    vector<int> m_terminal; // 每个单词对应的终止状态
+};
+
+/**
+ * @brief 多单词的 8 方向搜索
+ * 网格的每一行、每一列、每一条对角线和反对角线都只遍历一次, 正反两个方向各跑一遍自动机,
+ * 代价与单词数量基本无关
+ * @return 与 dictionary 一一对应的匹配数量
+ */
+vector<long long> countWords(const vector<string>& grid, const vector<string>& dictionary) {
+    WordAutomaton automaton(dictionary);
+    const int rows = grid.size();
+    int cols = 0;
+    for (const auto& line : grid) {
+        cols = max(cols, static_cast<int>(line.size()));
+    }
+    auto cell = [&](int r, int c) { return c < static_cast<int>(grid[r].size()) ? grid[r][c] : '\0'; };
 
+    vector<long long> hits(automaton.stateCount(), 0);
+    vector<char> line;
+    auto run = [&](auto first, auto last) {
+        int state = 0;
+        for (auto it = first; it != last; ++it) {
+            state = automaton.step(state, *it);
+            ++hits[state];
+        }
+    };
 
+    /* 行、列、对角线、反对角线: 从前一个格子在网格外的位置出发 */
+    const int lineDirections[4][2] = { {0, 1}, {1, 0}, {1, 1}, {1, -1} };
+    for (const auto& direction : lineDirections) {
+        const int dRow = direction[0];
+        const int dCol = direction[1];
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                const int prevRow = r - dRow, prevCol = c - dCol;
+                if (prevRow >= 0 && prevRow < rows && prevCol >= 0 && prevCol < cols) {
+                    continue;
+                }
+                line.clear();
+                for (int x = r, y = c; x < rows && y >= 0 && y < cols; x += dRow, y += dCol) {
+                    line.push_back(cell(x, y));
+                }
+                run(line.begin(), line.end());
+                run(line.rbegin(), line.rend());
+            }
+        }
+    }
+    hits[0] = 0;
+    return automaton.collect(move(hits));
+}
 
-int main() {
+int main(int argc, char* argv[]) {
+    // 用法: main [词表文件], 词表每行一个单词
     ifstream file("input.txt");
     if (!file.is_open()) {
         cerr << "无法打开文件 input.txt" << endl;
@@ -101,27 +321,36 @@ int main() {
     
     cout << "网格大小: " << grid.size() << " x " << (grid.empty() ? 0 : grid[0].size()) << endl;
 
+    LetterPlanes planes(grid);
+
     /* Part 1 */
-    int result_1 = 0;
-    string word = "XMAS";
-    for (int i = 0; i < grid.size(); ++i) {
-        for (int j = 0; j < grid[i].size(); ++j) {
-            result_1 += searchWord(grid, word, i, j);
-        }
-    }
+    long long result_1 = countWord(planes, "XMAS");
 
     cout << "Part 1 结果: " << result_1 << endl;
     
     /* Part 2 */
-    int result_2 = 0;
-    word = "MAS";
-    for (int i = 0; i < grid.size(); ++i) {
-        for (int j = 0; j < grid[i].size(); ++j) {
-            result_2 += searchWordX(grid, word, i, j);
-        }
-    }
+    long long result_2 = countWordX(planes, "MAS");
 
     cout << "Part 2 结果: " << result_2 << endl;
 
+    /* 词表搜索 */
+    if (argc > 1) {
+        ifstream wordFile(argv[1]);
+        if (!wordFile.is_open()) {
+            cerr << "无法打开词表文件 " << argv[1] << endl;
+            return 1;
+        }
+        vector<string> dictionary;
+        while (getline(wordFile, line)) {
+            if (!line.empty()) {
+                dictionary.push_back(line);
+            }
+        }
+        vector<long long> counts = countWords(grid, dictionary);
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            cout << dictionary[i] << ": " << counts[i] << endl;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
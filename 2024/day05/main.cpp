@@ -4,92 +4,216 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
-#include <map>
 #include <queue>
+#include <unordered_set>
+#include <cstdint>
+#include <span>
+#include "../../include/parallel.hpp"
 
 using namespace std;
 
-bool isValidUpdate(const vector<int>& queue, const vector<pair<int, int>>& rules) {
-    for (const auto& rule : rules) {
-        int before = rule.first;
-        int after = rule.second;
-        auto itBefore = find(queue.begin(), queue.end(), before);
-        auto itAfter = find(queue.begin(), queue.end(), after);
+/**
+ * 编译后的页面顺序规则: before(a, b) 表示存在规则 a|b
+ * 页面号较小时使用稠密位矩阵 (默认 100 x 100 只需 1250 字节), 否则使用哈希集合
+ * 规则只编译一次, 之后每次查询都是 O(1)
+ */
+class PrecedenceRules {
+public:
+    explicit PrecedenceRules(const vector<pair<int, int>>& rules) {
+        int maxPage = 0;
+        bool dense = true;
+        for (const auto& rule : rules) {
+            if (rule.first < 0 || rule.second < 0) {
+                dense = false;
+            }
+            maxPage = max({maxPage, rule.first, rule.second});
+        }
+        dense = dense && maxPage < denseLimit;
 
-        if (itBefore == queue.end() || itAfter == queue.end()) {
-            continue;
+        if (dense) {
+            m_size = max(maxPage + 1, 100);
+            m_matrix.assign((static_cast<size_t>(m_size) * m_size + 63) / 64, 0);
+            for (const auto& rule : rules) {
+                const size_t bit = static_cast<size_t>(rule.first) * m_size + rule.second;
+                m_matrix[bit / 64] |= uint64_t{1} << (bit % 64);
+            }
+        } else {
+            for (const auto& rule : rules) {
+                m_sparse.insert(key(rule.first, rule.second));
+            }
         }
-        if (itBefore > itAfter) {
-            return false; 
+    }
+
+    bool before(int a, int b) const {
+        if (!m_matrix.empty()) {
+            if (a < 0 || b < 0 || a >= m_size || b >= m_size) {
+                return false;
+            }
+            const size_t bit = static_cast<size_t>(a) * m_size + b;
+            return (m_matrix[bit / 64] >> (bit % 64)) & 1;
         }
+        return m_sparse.count(key(a, b)) != 0;
     }
-    return true;
-}
 
-void buildGraphFromRules(const vector<int>& queue, 
-                        const vector<pair<int, int>>& allRules,
-                        map<int, vector<int>>& graph,
-                        map<int, int>& inDegree) {
-    
-    // 第一步：初始化所有队列中的节点
-    for (int page : queue) {
-        graph[page] = vector<int>();  // 初始化邻接表
-        inDegree[page] = 0;          // 初始化入度为0
+private:
+    static constexpr int denseLimit = 1 << 12;
+
+    static uint64_t key(int a, int b) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
     }
-    
-    // 第二步：筛选适用于当前队列的规则
-    for (const auto& rule : allRules) {
-        int before = rule.first;
-        int after = rule.second;
-        
-        // 只考虑队列中都存在的页面之间的规则
-        if (find(queue.begin(), queue.end(), before) != queue.end() &&
-            find(queue.begin(), queue.end(), after) != queue.end()) {
-            
-            // 添加边：before -> after
-            graph[before].push_back(after);
-            
-            // after的入度加1
-            inDegree[after]++;
+
+    int m_size = 0;
+    vector<uint64_t> m_matrix;
+    unordered_set<uint64_t> m_sparse;
+};
+
+/**
+ * 队列合法 <=> 不存在 i < j 使得规则要求 queue[j] 在 queue[i] 之前, O(k^2) 次矩阵查询
+ */
+bool isValidUpdate(span<const int> queue, const PrecedenceRules& rules) {
+    for (size_t i = 0; i < queue.size(); ++i) {
+        for (size_t j = i + 1; j < queue.size(); ++j) {
+            if (rules.before(queue[j], queue[i])) {
+                return false;
+            }
         }
     }
+    return true;
 }
 
-void sortQueueByRules(vector<int>& queue, const vector<pair<int, int>>& rules) {
-    // 邻接表表示图
-    map<int, vector<int>> graph;  // 节点 -> 它指向的节点列表
-    map<int, int> inDegree;       // 节点 -> 入度
-    buildGraphFromRules(queue, rules, graph, inDegree);
+/**
+ * 规则在队列内是否构成全序关系, 此时可以直接用比较器排序:
+ * 任意两页之间恰好有一条规则, 且没有环 (等价于每页排在其前面的页数互不相同)
+ */
+bool isTotalOn(span<const int> queue, const PrecedenceRules& rules) {
+    const size_t k = queue.size();
+    vector<bool> seenRank(k, false);
+    for (size_t i = 0; i < k; ++i) {
+        size_t rank = 0;
+        for (size_t j = 0; j < k; ++j) {
+            if (i == j) {
+                continue;
+            }
+            const bool jFirst = rules.before(queue[j], queue[i]);
+            if (jFirst == rules.before(queue[i], queue[j])) {
+                return false;
+            }
+            rank += jFirst ? 1 : 0;
+        }
+        if (seenRank[rank]) {
+            return false;
+        }
+        seenRank[rank] = true;
+    }
+    return true;
+}
 
-    std::queue<int> zeroInDegreeQueue;
+// 规则不是全序时的后备方案: 基于矩阵的拓扑排序 (Kahn 算法), O(k^2)
+void topologicalSort(span<int> queue, const PrecedenceRules& rules) {
+    const size_t k = queue.size();
+    vector<int> inDegree(k, 0);
+    for (size_t i = 0; i < k; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            if (i != j && rules.before(queue[j], queue[i])) {
+                inDegree[i]++;
+            }
+        }
+    }
 
-    // 使用拓扑排序来排序队列
-    for (const auto& pair : inDegree) {
-        if (pair.second == 0) {  // 入度为0
-            zeroInDegreeQueue.push(pair.first);
+    std::queue<size_t> zeroInDegreeQueue;
+    for (size_t i = 0; i < k; ++i) {
+        if (inDegree[i] == 0) {
+            zeroInDegreeQueue.push(i);
         }
     }
 
     vector<int> sortedQueue;
     while (!zeroInDegreeQueue.empty()) {
-        int current = zeroInDegreeQueue.front();
+        size_t current = zeroInDegreeQueue.front();
         zeroInDegreeQueue.pop();
-        sortedQueue.push_back(current);
-
-        // 遍历当前节点的所有邻接节点
-        for (int neighbor : graph[current]) {
-            inDegree[neighbor]--;
-            if (inDegree[neighbor] == 0) {
-                zeroInDegreeQueue.push(neighbor);
+        sortedQueue.push_back(queue[current]);
+        for (size_t next = 0; next < k; ++next) {
+            if (next != current && rules.before(queue[current], queue[next]) && --inDegree[next] == 0) {
+                zeroInDegreeQueue.push(next);
             }
         }
     }
 
     if (sortedQueue.size() == queue.size()) {
-        queue = sortedQueue;  // 如果排序成功，更新原队列
+        copy(sortedQueue.begin(), sortedQueue.end(), queue.begin());  // 如果排序成功，更新原队列
     } else {
         cerr << "错误：无法对队列进行拓扑排序，可能存在循环依赖。" << endl;
-    }    
+    }
+}
+
+void sortQueueByRules(span<int> queue, const PrecedenceRules& rules) {
+    if (isTotalOn(queue, rules)) {
+        sort(queue.begin(), queue.end(), [&](int a, int b) { return rules.before(a, b); });
+        if (isValidUpdate(queue, rules)) {
+            return;
+        }
+    }
+    // 拓扑排序会报告循环依赖
+    topologicalSort(queue, rules);
+}
+
+/**
+ * 所有更新队列的扁平存储: 第 i 个队列为 pages[offsets[i], offsets[i + 1])
+ */
+struct UpdateBatch {
+    vector<int> pages;
+    vector<size_t> offsets{0};
+
+    size_t size() const { return offsets.size() - 1; }
+    span<int> update(size_t i) { return span<int>(pages).subspan(offsets[i], offsets[i + 1] - offsets[i]); }
+};
+
+struct BatchResult {
+    vector<uint8_t> valid;            // 每个队列是否符合规则
+    long long validMiddleSum = 0;     // Part 1: 合法队列的中间页之和
+    long long reorderedMiddleSum = 0; // Part 2: 不合法队列重排后的中间页之和
+};
+
+// 中间页, 偶数长度时取中间两页的平均值
+long long middlePage(span<const int> queue) {
+    if (queue.size() % 2 == 1) {
+        return queue[queue.size() / 2];
+    }
+    return (queue[queue.size() / 2 - 1] + queue[queue.size() / 2]) / 2;
+}
+
+/**
+ * @brief 批量校验更新队列
+ * 队列按区间分给线程池, 每个队列在同一次遍历中完成校验; 不合法的队列直接在扁平数组中原地重排
+ * 规则集只编译一次, 可以在多个批次之间复用
+ */
+BatchResult checkUpdates(const PrecedenceRules& rules, UpdateBatch& batch, thread_pool& pool) {
+    BatchResult result;
+    result.valid.assign(batch.size(), 0);
+    const unsigned chunks = min<size_t>(max<size_t>(batch.size() / 64, 1), pool.size() * 4);
+    vector<pair<long long, long long>> partial(chunks, {0, 0});
+
+    pool.for_chunks(batch.size(), chunks, [&](unsigned c, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            span<int> queue = batch.update(i);
+            if (queue.empty()) {
+                continue;
+            }
+            if (isValidUpdate(queue, rules)) {
+                result.valid[i] = 1;
+                partial[c].first += middlePage(queue);
+            } else {
+                sortQueueByRules(queue, rules);
+                partial[c].second += middlePage(queue);
+            }
+        }
+    });
+
+    for (const auto& [validSum, reorderedSum] : partial) {
+        result.validMiddleSum += validSum;
+        result.reorderedMiddleSum += reorderedSum;
+    }
+    return result;
 }
 
 int main() {
@@ -101,7 +225,8 @@ int main() {
     
     vector<pair<int, int>> rules;
     
-    vector<vector<int>> updates;
+    UpdateBatch updates;
+    vector<int> queue;
     
     string line;
     bool readingRules = true;
@@ -133,7 +258,7 @@ int main() {
         } else {
             stringstream ss(line);
             string pagePart;
-            vector<int> queue;
+            queue.clear();
             while (getline(ss, pagePart, ',')) {
                 int pageNumber;
                 try {
@@ -144,7 +269,8 @@ int main() {
                 }
             }
             if (!queue.empty()) {
-                updates.push_back(queue);
+                updates.pages.insert(updates.pages.end(), queue.begin(), queue.end());
+                updates.offsets.push_back(updates.pages.size());
             } else {
                 cerr << "更新队列为空或格式错误: " << line << endl;
             }
@@ -155,54 +281,18 @@ int main() {
     cout << "规则数量: " << rules.size() << endl;
     cout << "更新队列数量: " << updates.size() << endl;
 
-    /* Part 1 */
-    vector<vector<int>> validUpdates;
-    vector<vector<int>> invalidUpdates;
+    // 规则只编译一次
+    const PrecedenceRules compiledRules(rules);
 
-    for (const auto& queue : updates) {
-        if (isValidUpdate(queue, rules)) {
-            validUpdates.push_back(queue);
-        } else {
-            invalidUpdates.push_back(queue);
-        }
-    }
-    cout << "符合规则的更新队列数量: " << validUpdates.size() << endl;
-    cout << "不符合规则的更新队列数量: " << invalidUpdates.size() << endl;
-    
-    int result = 0;
-    for (const auto& queue : validUpdates) {
-        if (queue.size() % 2 == 1) {
-            int midIndex = queue.size() / 2;
-            result += queue[midIndex];
-        } else {
-            int midIndex1 = queue.size() / 2 - 1;
-            int midIndex2 = queue.size() / 2;
-            result += (queue[midIndex1] + queue[midIndex2]) / 2;
-        }
-    }
-    
-    cout << "Part 1 结果: " << result << endl;
+    /* Part 1 & Part 2 */
+    thread_pool pool;
+    BatchResult batchResult = checkUpdates(compiledRules, updates, pool);
+    const size_t validCount = count(batchResult.valid.begin(), batchResult.valid.end(), 1);
 
-    /* Part 2 */
-    for (auto& queue : invalidUpdates) {
-        sortQueueByRules(queue, rules);
-    }    
-
-    int invalidResult = 0;
-    for (const auto& queue : invalidUpdates) {
-        if (queue.size() % 2 == 1) {
-            int midIndex = queue.size() / 2;
-            invalidResult += queue[midIndex];
-
-        } else {
-            int midIndex1 = queue.size() / 2 - 1;
-            int midIndex2 = queue.size() / 2;
-            invalidResult += (queue[midIndex1] + queue[midIndex2]) / 2;
-        }
-    }
-
-
-    cout << "Part 2 结果: " << invalidResult << endl;
+    cout << "符合规则的更新队列数量: " << validCount << endl;
+    cout << "不符合规则的更新队列数量: " << updates.size() - validCount << endl;
+    cout << "Part 1 结果: " << batchResult.validMiddleSum << endl;
+    cout << "Part 2 结果: " << batchResult.reorderedMiddleSum << endl;
     
     return 0;
-}
\ No newline at end of file
+}
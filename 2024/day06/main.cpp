@@ -2,7 +2,9 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <set>
+#include <cstdint>
+#include <algorithm>
+#include "../../include/parallel.hpp"
 
 using namespace std;
 
@@ -70,6 +72,106 @@ struct State
   }
 };
 
+// 方向向量: UP, RIGHT, DOWN, LEFT
+const int directionRows[] = {-1, 0, 1, 0};
+const int directionCols[] = {0, 1, 0, -1};
+
+// 跳转表: stop[dir][cell] = 从 cell 朝 dir 前进, 在下一个障碍物前停下的格子; 走出地图则为 EXIT_MAP
+// cell = row * cols + col, 每次模拟直接从一个转弯点跳到下一个转弯点
+const int EXIT_MAP = -1;
+
+struct JumpTable
+{
+  int rows = 0;
+  int cols = 0;
+  vector<int> stop[4];
+};
+
+JumpTable buildJumpTable(const vector<string> &grid)
+{
+  JumpTable table;
+  table.rows = grid.size();
+  table.cols = grid.empty() ? 0 : grid[0].size();
+  const int rows = table.rows;
+  const int cols = table.cols;
+  for (auto &stop : table.stop)
+  {
+    stop.assign(static_cast<size_t>(rows) * cols, EXIT_MAP);
+  }
+
+  for (int dir = 0; dir < 4; ++dir)
+  {
+    // 按移动方向的反方向扫描, 使前方格子的结果先算好
+    const bool reverseRows = directionRows[dir] > 0;
+    const bool reverseCols = directionCols[dir] > 0;
+    for (int i = 0; i < rows; ++i)
+    {
+      const int r = reverseRows ? rows - 1 - i : i;
+      for (int j = 0; j < cols; ++j)
+      {
+        const int c = reverseCols ? cols - 1 - j : j;
+        if (grid[r][c] == '#')
+        {
+          continue;
+        }
+        const int nextRow = r + directionRows[dir];
+        const int nextCol = c + directionCols[dir];
+        int &stop = table.stop[dir][r * cols + c];
+        if (nextRow < 0 || nextRow >= rows || nextCol < 0 || nextCol >= cols)
+        {
+          stop = EXIT_MAP;
+        }
+        else if (grid[nextRow][nextCol] == '#')
+        {
+          stop = r * cols + c;
+        }
+        else
+        {
+          stop = table.stop[dir][nextRow * cols + nextCol];
+        }
+      }
+    }
+  }
+  return table;
+}
+
+// 沿 dir 方向的坐标, 前进时单调递增
+inline int progressAlong(int row, int col, int dir)
+{
+  return row * directionRows[dir] + col * directionCols[dir];
+}
+
+/**
+ * 从 cell 朝 dir 前进的停止格子, 额外考虑一个新障碍物 (obstacleRow, obstacleCol)
+ * 跳转表本身不修改: 新障碍物只影响同一行/列上的跳转, 用 O(1) 的比较即可修正
+ */
+int nextStop(const JumpTable &table, int cell, int dir, int obstacleRow, int obstacleCol)
+{
+  const int target = table.stop[dir][cell];
+  if (obstacleRow < 0)
+  {
+    return target;
+  }
+  const int row = cell / table.cols;
+  const int col = cell % table.cols;
+  const bool sameLine = directionRows[dir] != 0 ? col == obstacleCol : row == obstacleRow;
+  if (!sameLine)
+  {
+    return target;
+  }
+  const int here = progressAlong(row, col, dir);
+  const int obstacle = progressAlong(obstacleRow, obstacleCol, dir);
+  if (obstacle <= here)
+  {
+    return target; // 新障碍物在身后
+  }
+  if (target != EXIT_MAP && obstacle > progressAlong(target / table.cols, target % table.cols, dir))
+  {
+    return target; // 原有障碍物更近
+  }
+  return (obstacleRow - directionRows[dir]) * table.cols + (obstacleCol - directionCols[dir]);
+}
+
 // 预计算原始路径的详细信息
 vector<State> computeOriginalPath(const vector<string> &grid, int startRow, int startCol, Direction startDir)
 {
@@ -78,10 +180,6 @@ vector<State> computeOriginalPath(const vector<string> &grid, int startRow, int
   int currentCol = startCol;
   int currentDir = startDir;
 
-  // 方向向量
-  int directionRows[] = {-1, 0, 1, 0}; // UP, RIGHT, DOWN, LEFT
-  int directionCols[] = {0, 1, 0, -1};
-
   while (true)
   {
     // 记录当前状态
@@ -115,84 +213,90 @@ vector<State> computeOriginalPath(const vector<string> &grid, int startRow, int
   return path;
 }
 
-// 优化的循环检测函数
-bool detectLoopOptimized(const vector<string> &grid, const vector<State> &originalPath,
-                         int obstacleRow, int obstacleCol, int startRow, int startCol, Direction startDir)
+// 访问过的 (格子, 方向) 状态: 扁平的 rows * cols * 4 数组, 用代数 (epoch) 标记
+// reset() 只把代数加一, 清空的代价为 O(1), 候选障碍物之间不需要重新分配或清零
+struct VisitedStates
 {
-  // 找到警卫第一次会遇到新障碍物的位置
-  int startIndex = -1;
-  for (int i = 0; i < originalPath.size(); i++)
-  {
-    State state = originalPath[i];
+  vector<uint32_t> stamp;
+  uint32_t epoch = 0;
 
-    // 计算下一个位置
-    int directionRows[] = {-1, 0, 1, 0};
-    int directionCols[] = {0, 1, 0, -1};
-    int nextRow = state.row + directionRows[state.dir];
-    int nextCol = state.col + directionCols[state.dir];
+  explicit VisitedStates(size_t cells) : stamp(cells * 4, 0)
+  {
+  }
 
-    // 如果下一个位置是新障碍物的位置
-    if (nextRow == obstacleRow && nextCol == obstacleCol)
+  void reset()
+  {
+    if (++epoch == 0)
     {
-      startIndex = i;
-      break;
+      // 代数回绕时才真正清零一次
+      fill(stamp.begin(), stamp.end(), 0);
+      epoch = 1;
     }
   }
 
-  // 如果警卫永远不会遇到这个障碍物，不会形成循环
-  if (startIndex == -1)
+  // 标记状态, 返回该状态在本代中是否已经访问过
+  bool testAndSet(int cell, int dir)
   {
+    uint32_t &slot = stamp[static_cast<size_t>(cell) * 4 + dir];
+    if (slot == epoch)
+    {
+      return true;
+    }
+    slot = epoch;
     return false;
   }
+};
 
-  // 从遇到障碍物的位置开始模拟
-  State startState = originalPath[startIndex];
+// 每个格子的首次到达索引: firstHit[cell] = originalPath 中第一个"下一步将进入 cell"的状态下标, 没有则为 -1
+// 在 cell 放置障碍物后, 警卫在这个状态之前的路线不受影响
+vector<int> computeFirstHit(const JumpTable &jumps, const vector<State> &originalPath)
+{
+  vector<int> firstHit(static_cast<size_t>(jumps.rows) * jumps.cols, -1);
+  for (int i = 0; i < static_cast<int>(originalPath.size()); i++)
+  {
+    const State &state = originalPath[i];
+    int nextRow = state.row + directionRows[state.dir];
+    int nextCol = state.col + directionCols[state.dir];
+    if (nextRow < 0 || nextRow >= jumps.rows || nextCol < 0 || nextCol >= jumps.cols)
+    {
+      continue;
+    }
+    int &slot = firstHit[nextRow * jumps.cols + nextCol];
+    if (slot == -1)
+    {
+      slot = i;
+    }
+  }
+  return firstHit;
+}
 
-  set<State> visitedStates;
-  int currentRow = startState.row;
-  int currentCol = startState.col;
+// 优化的循环检测函数: 在跳转表上从一个转弯点跳到下一个转弯点
+bool detectLoopOptimized(const JumpTable &jumps, const State &startState, int obstacleRow, int obstacleCol,
+                         VisitedStates &visitedStates)
+{
+  // 从遇到障碍物的位置开始模拟
+  visitedStates.reset();
+  int currentCell = startState.row * jumps.cols + startState.col;
   int currentDir = startState.dir;
 
-  // 方向向量
-  int directionRows[] = {-1, 0, 1, 0};
-  int directionCols[] = {0, 1, 0, -1};
-
   while (true)
   {
-    State currentState = {currentRow, currentCol, currentDir};
-
-    // 检查是否形成循环
-    if (visitedStates.count(currentState))
+    // 检查是否形成循环 (只记录每段直线的起点)
+    if (visitedStates.testAndSet(currentCell, currentDir))
     {
       return true;
     }
 
-    visitedStates.insert(currentState);
-
-    // 计算下一个位置
-    int nextRow = currentRow + directionRows[currentDir];
-    int nextCol = currentCol + directionCols[currentDir];
-
-    // 检查边界
-    if (nextRow < 0 || nextRow >= grid.size() ||
-        nextCol < 0 || nextCol >= grid[0].size())
+    // 直接跳到下一个障碍物前（包括新添加的）
+    int stop = nextStop(jumps, currentCell, currentDir, obstacleRow, obstacleCol);
+    if (stop == EXIT_MAP)
     {
       return false; // 离开地图，不是循环
     }
 
-    // 检查障碍物（包括新添加的）
-    if (grid[nextRow][nextCol] == '#' ||
-        (nextRow == obstacleRow && nextCol == obstacleCol))
-    {
-      // 遇到障碍物，转向
-      currentDir = (currentDir + 1) % 4;
-    }
-    else
-    {
-      // 前进
-      currentRow = nextRow;
-      currentCol = nextCol;
-    }
+    // 遇到障碍物，转向
+    currentCell = stop;
+    currentDir = (currentDir + 1) % 4;
   }
 }
 
@@ -232,81 +336,95 @@ int main()
 
   int currentDirection = charToDirection(guardDirection);
 
-  set<pair<int, int>> visitedPositions;
-
-  int currentRow = guardRow;
-  int currentCol = guardCol;
+  const JumpTable jumps = buildJumpTable(grid);
+  const int cols = jumps.cols;
+  vector<uint8_t> visitedPositions(static_cast<size_t>(jumps.rows) * cols, 0);
+  int currentCell = guardRow * cols + guardCol;
 
   // 移动规则：
-  // 1. 如果前方没有障碍物('#')，向前移动一步
+  // 1. 如果前方没有障碍物('#')，向前移动
   // 2. 如果前方有障碍物，向顺时针转90度
   // 3. 如果走出地图边界，停止移动
   // 4. 记录每个访问过的位置
-  visitedPositions.insert({currentRow, currentCol}); // 记录起始位置
+  // 跳转表给出每一段直线的终点, 只需把这一段上的格子记为访问过
   while (true)
   {
-    int nextRow = currentRow;
-    int nextCol = currentCol;
-    switch (currentDirection)
+    const int stop = jumps.stop[currentDirection][currentCell];
+    int row = currentCell / cols;
+    int col = currentCell % cols;
+    const int rows = jumps.rows;
+    while (true)
     {
-    case UP:
-      nextRow--;
-      break;
-    case RIGHT:
-      nextCol++;
-      break;
-    case DOWN:
-      nextRow++;
-      break;
-    case LEFT:
-      nextCol--;
-      break;
+      visitedPositions[row * cols + col] = 1;
+      if (row * cols + col == stop)
+      {
+        break;
+      }
+      const int nextRow = row + directionRows[currentDirection];
+      const int nextCol = col + directionCols[currentDirection];
+      if (nextRow < 0 || nextRow >= rows || nextCol < 0 || nextCol >= cols)
+      {
+        break;
+      }
+      row = nextRow;
+      col = nextCol;
     }
-    if (nextRow < 0 || nextRow >= grid.size() || nextCol < 0 || nextCol >= grid[0].size())
+    if (stop == EXIT_MAP)
     {
       // 如果走出地图边界，停止移动
       break;
     }
-    if (grid[nextRow][nextCol] == '#')
-    {
-      // 如果前方有障碍物，向顺时针转90度
-      currentDirection = (currentDirection + 1) % 4;
-    }
-    else
-    {
-      // 否则，向前移动一步
-      currentRow = nextRow;
-      currentCol = nextCol;
-      visitedPositions.insert({currentRow, currentCol});
-    }
+    // 前方有障碍物，向顺时针转90度
+    currentCell = stop;
+    currentDirection = (currentDirection + 1) % 4;
   }
 
-  cout << "警卫访问了 " << visitedPositions.size() << " 个不同的位置" << endl;
+  cout << "警卫访问了 " << count(visitedPositions.begin(), visitedPositions.end(), 1) << " 个不同的位置" << endl;
 
   /* Part 2 */
 
   // 预计算原始路径
   vector<State> originalPath = computeOriginalPath(grid, guardRow, guardCol, charToDirection(guardDirection));
 
-  int loopCount = 0;
+  vector<int> firstHit = computeFirstHit(jumps, originalPath);
 
-  // 只在原始路径经过的位置测试障碍物
-  for (const auto &pos : visitedPositions)
+  // 只在原始路径经过的位置测试障碍物 (跳过起始位置)
+  vector<int> candidates;
+  for (int cell = 0; cell < static_cast<int>(visitedPositions.size()); ++cell)
   {
-    int testRow = pos.first;
-    int testCol = pos.second;
-
-    // 跳过起始位置
-    if (testRow == guardRow && testCol == guardCol)
+    if (visitedPositions[cell] && cell != guardRow * cols + guardCol)
     {
-      continue;
+      candidates.push_back(cell);
     }
+  }
 
-    // 使用优化的循环检测
-    if (detectLoopOptimized(grid, originalPath, testRow, testCol, guardRow, guardCol, charToDirection(guardDirection)))
+  // 各个候选障碍物互相独立: 分给多个线程, 每个线程有自己的访问标记数组
+  const unsigned threads = min<size_t>(default_thread_count(), max<size_t>(candidates.size() / 64, 1));
+  vector<int> loopCounts(threads, 0);
+  parallel_for_chunks(candidates.size(), threads, [&](unsigned t, size_t begin, size_t end) {
+    VisitedStates visitedStates(visitedPositions.size());
+    int count = 0;
+    for (size_t i = begin; i < end; ++i)
     {
-      loopCount++;
+      const int cell = candidates[i];
+      // 如果警卫永远不会遇到这个障碍物，不会形成循环
+      if (firstHit[cell] == -1)
+      {
+        continue;
+      }
+      // 使用优化的循环检测
+      if (detectLoopOptimized(jumps, originalPath[firstHit[cell]], cell / cols, cell % cols, visitedStates))
+      {
+        count++;
+      }
     }
+    loopCounts[t] = count;
+  });
+
+  int loopCount = 0;
+  for (int count : loopCounts)
+  {
+    loopCount += count;
   }
 
   cout << "Part 2 结果: " << loopCount << endl;
@@ -3,42 +3,331 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "../../include/bench.hpp"
+#include "../../include/digits.hpp"
+#include "../../include/int_scanner.hpp"
+#include "../../include/parallel.hpp"
 
 using namespace std;
 
-long long connect(long long a, long long b)
+// 逆向求解: 从测试值出发, 从最后一个数字开始逐个"撤销"运算符
+//   + : 只有 target >= x 时才能撤销为 target - x
+//   * : 只有 x 整除 target 时才能撤销为 target / x
+//   ||: 只有 target 的末尾数字恰好是 x 时才能撤销 (去掉末尾的 x)
+// 大部分分支在第一步就被剪掉, 不必枚举全部 3^n 种运算符组合
+// 运行时判断运算符的版本, 仅作为 --bench 的对照
+bool canReach(long long target, const vector<long long> &data, size_t index, bool allowConcat)
 {
-  stringstream ss;
-  ss << a << b;
-  return stoll(ss.str());
+  const long long x = data[index];
+  if (index == 0)
+  {
+    return target == x;
+  }
+  if (target >= x && canReach(target - x, data, index - 1, allowConcat))
+  {
+    return true;
+  }
+  if (x == 0 ? target == 0 : target % x == 0 && canReach(target / x, data, index - 1, allowConcat))
+  {
+    return true;
+  }
+  if (allowConcat && target >= x)
+  {
+    long long base = 10;
+    while (base <= x)
+    {
+      base *= 10;
+    }
+    if ((target - x) % base == 0 && canReach((target - x) / base, data, index - 1, allowConcat))
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
-// 校验输入是否有效的函数
-bool helper(long long currentValue, const vector<long long> &data, size_t index, long long testValue)
+// 大于 x 的最小的 10 的幂, 即拼接 x 时左侧需要乘的倍数: a || x = a * 10^digits(x) + x
+inline long long concatBase(long long x)
+{
+  return pow10[digit_count(x)];
+}
+
+// 运算符: undo 把 "prev op x == target" 反推为 prev, 不可能时返回 false
+struct Add
+{
+  static bool undo(long long target, long long x, long long &prev)
+  {
+    prev = target - x;
+    return target >= x;
+  }
+};
+
+struct Multiply
+{
+  static bool undo(long long target, long long x, long long &prev)
+  {
+    if (x == 0 || target % x != 0)
+    {
+      return false;
+    }
+    prev = target / x;
+    return true;
+  }
+};
+
+struct Concat
 {
-  if (index == data.size())
+  static bool undo(long long target, long long x, long long &prev)
   {
-    return currentValue == testValue;
+    if (target < x || x >= pow10.back())
+    {
+      return false; // 19 位的操作数拼接后必然溢出
+    }
+    const long long base = concatBase(x);
+    if ((target - x) % base != 0)
+    {
+      return false;
+    }
+    prev = (target - x) / base;
+    return true;
   }
-  if (currentValue > testValue)
+};
+
+// 运算符集合作为模板参数包, 编译期为每种组合生成专门的求解器, 运行时不再判断运算符种类
+template <typename... Ops>
+bool canReachWith(long long target, const long long *data, size_t index)
+{
+  if (index == 0)
   {
-    return false; // 如果当前值已经超过测试值，直接返回 false
+    return target == data[0];
   }
-  return  helper(currentValue + data[index], data, index + 1, testValue) ||
-          helper(currentValue * data[index], data, index + 1, testValue) ||
-          helper(connect(currentValue, data[index]), data, index + 1, testValue);
+  const long long x = data[index];
+  if (x == 0 && target == 0 && (is_same_v<Ops, Multiply> || ...))
+  {
+    return true; // 任何前缀乘以 0 都得 0, undo 无法反推出前缀
+  }
+  long long prev = 0;
+  return ((Ops::undo(target, x, prev) && canReachWith<Ops...>(prev, data, index - 1)) || ...);
 }
 
 // 校验输入是否有效的函数
+// Part 1: isValidInput<Add, Multiply>; Part 2: isValidInput<Add, Multiply, Concat>
+template <typename... Ops>
 bool isValidInput(long long testValue, const vector<long long> &data)
 {
   /* 想法1 暴力解法: 用数组保存计算步骤, 对于每一步和上一步相乘或相加 如果最后有等于testValue的结果返回True */
   /* 尝试1 递归解法 使用递归计算 */
-  return helper(data[0], data, 1, testValue);
+  /* 尝试2 逆向递归 从测试值反推, 只保留能整除/能减/末尾匹配的分支 */
+  return !data.empty() && canReachWith<Ops...>(testValue, data.data(), data.size() - 1);
 }
 
-int main()
+// 一批方程的扁平存储: 第 i 个方程的数字为 numbers[offsets[i], offsets[i + 1])
+struct EquationBatch
+{
+  vector<long long> testValues;
+  vector<long long> numbers;
+  vector<size_t> offsets{0};
+
+  size_t size() const
+  {
+    return testValues.size();
+  }
+
+  void clear()
+  {
+    testValues.clear();
+    numbers.clear();
+    offsets.assign(1, 0);
+  }
+};
+
+// 两部分的校准结果
+struct CalibrationTotals
 {
+  long long sum = 0;
+  int count = 0;
+  long long sumWithConcat = 0;
+  int countWithConcat = 0;
+
+  void add(const CalibrationTotals &other)
+  {
+    sum += other.sum;
+    count += other.count;
+    sumWithConcat += other.sumWithConcat;
+    countWithConcat += other.countWithConcat;
+  }
+};
+
+void solveBatch(const EquationBatch &batch, CalibrationTotals &totals)
+{
+  for (size_t i = 0; i < batch.size(); ++i)
+  {
+    const long long *data = batch.numbers.data() + batch.offsets[i];
+    const size_t length = batch.offsets[i + 1] - batch.offsets[i];
+    const long long testValue = batch.testValues[i];
+    if (length == 0)
+    {
+      continue;
+    }
+    if (canReachWith<Add, Multiply>(testValue, data, length - 1))
+    {
+      totals.sum += testValue;
+      totals.count++;
+    }
+    if (canReachWith<Add, Multiply, Concat>(testValue, data, length - 1))
+    {
+      totals.sumWithConcat += testValue;
+      totals.countWithConcat++;
+    }
+  }
+}
+
+/**
+ * 流水线模式: 当前线程负责解析, 每 batchSize 个方程打包成一批交给工作线程求解
+ * 批次对象在 空闲队列 -> 待求解队列 -> 空闲队列 之间循环复用, 同时存在的批次数固定,
+ * 因此无论文件多大, 解析占用的内存都是有界的
+ */
+CalibrationTotals solveStreaming(istream &input, unsigned workers, size_t batchSize)
+{
+  workers = max(1u, workers);
+  const size_t batchCount = workers * 2;
+  bounded_queue<EquationBatch *> freeBatches(batchCount);
+  bounded_queue<EquationBatch *> pendingBatches(batchCount);
+  vector<EquationBatch> batches(batchCount);
+  for (auto &batch : batches)
+  {
+    freeBatches.push(&batch);
+  }
+
+  vector<CalibrationTotals> partial(workers);
+  vector<jthread> threads;
+  for (unsigned t = 0; t < workers; ++t)
+  {
+    threads.emplace_back([&, t]() {
+      while (auto batch = pendingBatches.pop())
+      {
+        solveBatch(**batch, partial[t]);
+        (*batch)->clear();
+        freeBatches.push(*batch);
+      }
+    });
+  }
+
+  string line;
+  EquationBatch *current = *freeBatches.pop();
+  while (getline(input, line))
+  {
+    const size_t colonPos = line.find(':');
+    if (colonPos == string::npos)
+    {
+      continue;
+    }
+    long long testValue = 0;
+    int_scanner testScanner(string_view(line).substr(0, colonPos));
+    if (!testScanner.next(testValue))
+    {
+      continue;
+    }
+    current->testValues.push_back(testValue);
+    int_scanner numberScanner(string_view(line).substr(colonPos + 1));
+    long long num = 0;
+    while (numberScanner.next(num))
+    {
+      current->numbers.push_back(num);
+    }
+    current->offsets.push_back(current->numbers.size());
+
+    if (current->size() == batchSize)
+    {
+      pendingBatches.push(current);
+      current = *freeBatches.pop();
+    }
+  }
+  pendingBatches.push(current);
+  pendingBatches.close();
+  threads.clear(); // 等待所有工作线程结束
+
+  CalibrationTotals totals;
+  for (const auto &part : partial)
+  {
+    totals.add(part);
+  }
+  return totals;
+}
+
+// 每个方程的平均求解耗时: 运行时判断运算符 (canReach) 与编译期特化 (canReachWith)
+// 输入末尾附加几个含 0 操作数的方程, 两种求解器的有效方程数必须一致
+void runBenchmark(vector<long long> testValues, vector<vector<long long>> numbers)
+{
+  const pair<long long, vector<long long>> zeroCases[] = {{3, {2, 0, 3}}, {0, {7, 0}}, {12, {0, 4, 3}}, {50, {5, 0, 50}}};
+  for (const auto &[testValue, data] : zeroCases)
+  {
+    testValues.push_back(testValue);
+    numbers.push_back(data);
+  }
+
+  const int repeats = 20;
+  int checksum = 0;
+  auto perEquationNs = [&](auto &&solve) {
+    const double ms = measure_ms([&] {
+      for (int r = 0; r < repeats; ++r)
+      {
+        for (size_t i = 0; i < testValues.size(); ++i)
+        {
+          checksum += solve(testValues[i], numbers[i]) ? 1 : 0;
+        }
+      }
+    });
+    return ms * 1e6 / (static_cast<double>(repeats) * testValues.size());
+  };
+  auto validCount = [&](auto &&solve) {
+    int count = 0;
+    for (size_t i = 0; i < testValues.size(); ++i)
+    {
+      count += solve(testValues[i], numbers[i]) ? 1 : 0;
+    }
+    return count;
+  };
+  auto report = [&](const char *part, auto &&before, auto &&after) {
+    const int expected = validCount(before);
+    const int actual = validCount(after);
+    cout << part << " 运行时运算符: " << perEquationNs(before) << " ns/方程" << endl;
+    cout << part << " 编译期运算符: " << perEquationNs(after) << " ns/方程" << endl;
+    cout << part << " 有效方程数: " << expected << " / " << actual << (expected == actual ? "" : " (不一致)") << endl;
+  };
+
+  auto runtime = [](bool allowConcat) {
+    return [allowConcat](long long testValue, const vector<long long> &data) {
+      return canReach(testValue, data, data.size() - 1, allowConcat);
+    };
+  };
+  report("Part 1", runtime(false), isValidInput<Add, Multiply>);
+  report("Part 2", runtime(true), isValidInput<Add, Multiply, Concat>);
+  cout << "(checksum " << checksum << ")" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  // 用法: main [--bench | --stream]
+  if (argc > 1 && string(argv[1]) == "--stream")
+  {
+    ifstream streamFile("input.txt");
+    if (!streamFile.is_open())
+    {
+      cerr << "错误：无法打开 input.txt 文件" << endl;
+      return 1;
+    }
+    CalibrationTotals totals = solveStreaming(streamFile, default_thread_count(), 4096);
+    cout << "Part 1 有效输入的总和: " << totals.sum << endl;
+    cout << "Part 1 有效输入的数量: " << totals.count << endl;
+    cout << "Part 2 有效输入的总和: " << totals.sumWithConcat << endl;
+    cout << "Part 2 有效输入的数量: " << totals.countWithConcat << endl;
+    return 0;
+  }
   ifstream inputFile("input.txt");
   if (!inputFile.is_open())
   {
@@ -73,18 +362,34 @@ int main()
   inputFile.close();
   cout << "读取到 " << testValues.size() << " 行数据。" << endl;
 
-  /* Part 1 */
+  if (argc > 1 && string(argv[1]) == "--bench")
+  {
+    runBenchmark(testValues, numbers);
+    return 0;
+  }
+
+  /* Part 1: + 和 * */
   long long sum = 0;
   int count = 0;
+  /* Part 2: + 、 * 和 || */
+  long long sumWithConcat = 0;
+  int countWithConcat = 0;
   for (int i = 0; i < testValues.size(); ++i)
   {
-    if (isValidInput(testValues[i], numbers[i]))
+    if (isValidInput<Add, Multiply>(testValues[i], numbers[i]))
     {
       sum += testValues[i];
       count++;
     }
+    if (isValidInput<Add, Multiply, Concat>(testValues[i], numbers[i]))
+    {
+      sumWithConcat += testValues[i];
+      countWithConcat++;
+    }
   }
-  cout << "有效输入的总和: " << sum << endl;
-  cout << "有效输入的数量: " << count << endl;
+  cout << "Part 1 有效输入的总和: " << sum << endl;
+  cout << "Part 1 有效输入的数量: " << count << endl;
+  cout << "Part 2 有效输入的总和: " << sumWithConcat << endl;
+  cout << "Part 2 有效输入的数量: " << countWithConcat << endl;
   return 0;
 }
\ No newline at end of file
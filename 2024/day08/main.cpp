@@ -3,8 +3,12 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <set>
 #include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <bit>
+#include <algorithm>
+#include "../../include/render.hpp"
 
 using namespace std;
 
@@ -27,95 +31,124 @@ bool isInBounds(const Point& p, int rows, int cols) {
     return p.x >= 0 && p.x < rows && p.y >= 0 && p.y < cols;
 }
 
-// 计算两个天线产生的反节点
-vector<Point> calculateAntinodes(const Point& antenna1, const Point& antenna2) {
-    vector<Point> antinodes;
-    
+// 反节点位图: 按行优先存储, 每个格子 1 bit, 用 popcount 计数
+class AntinodeGrid {
+public:
+    AntinodeGrid(int rows, int cols)
+        : m_rows(rows), m_cols(cols), m_bits((static_cast<size_t>(rows) * cols + 63) / 64, 0) {}
+
+    // 标记 p, 超出地图范围时忽略
+    void mark(const Point& p) {
+        if (isInBounds(p, m_rows, m_cols)) {
+            const size_t index = static_cast<size_t>(p.x) * m_cols + p.y;
+            m_bits[index / 64] |= uint64_t{1} << (index % 64);
+        }
+    }
+
+    bool test(int x, int y) const {
+        const size_t index = static_cast<size_t>(x) * m_cols + y;
+        return (m_bits[index / 64] >> (index % 64)) & 1;
+    }
+
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t word : m_bits) {
+            total += popcount(word);
+        }
+        return total;
+    }
+
+    void merge(const AntinodeGrid& other) {
+        for (size_t i = 0; i < m_bits.size(); ++i) {
+            m_bits[i] |= other.m_bits[i];
+        }
+    }
+
+    void clear() {
+        fill(m_bits.begin(), m_bits.end(), 0);
+    }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+
+private:
+    int m_rows;
+    int m_cols;
+    vector<uint64_t> m_bits;
+};
+
+// 标记两个天线产生的反节点
+void markAntinodes(const Point& antenna1, const Point& antenna2, AntinodeGrid& antinodes) {
     int dx = antenna2.x - antenna1.x;
     int dy = antenna2.y - antenna1.y;
     
     // 反节点1：从天线1出发，延伸2倍距离
-    int antinode1_x = antenna1.x + 2 * dx;
-    int antinode1_y = antenna1.y + 2 * dy;
-    
+    antinodes.mark(Point(antenna1.x + 2 * dx, antenna1.y + 2 * dy));
     // 反节点2：从天线2出发，延伸2倍距离（反方向）
-    int antinode2_x = antenna2.x - 2 * dx;
-    int antinode2_y = antenna2.y - 2 * dy;
-    
-    Point antinode1(antinode1_x, antinode1_y);
-    Point antinode2(antinode2_x, antinode2_y);
-    antinodes.push_back(antinode1);
-    antinodes.push_back(antinode2);
-    return antinodes;
+    antinodes.mark(Point(antenna2.x - 2 * dx, antenna2.y - 2 * dy));
 }
 
-vector<Point> calculateAntinodesPartTwo(const Point& antenna1, const Point& antenna2, int rows, int cols) {
-    vector<Point> antinodes;
-
+// 标记两个天线所在直线上的所有格点
+// 步长为 (dx / g, dy / g), g = gcd(dx, dy), 这样不会漏掉两个天线之间及外侧的格点
+void markAntinodesPartTwo(const Point& antenna1, const Point& antenna2, AntinodeGrid& antinodes) {
     int dx = antenna2.x - antenna1.x;
     int dy = antenna2.y - antenna1.y;
+    const int g = gcd(dx, dy);
+    if (g == 0) {
+        return;  // 两个天线重合
+    }
+    dx /= g;
+    dy /= g;
 
     // 从antenna1开始，向两个方向延伸
     // 正方向
-    for (int i = 0;; i++)
-    {
-      Point p(antenna1.x + i * dx, antenna1.y + i * dy);
-      if (!isInBounds(p, rows, cols))
-        break;
-      antinodes.push_back(p);
+    for (Point p = antenna1; isInBounds(p, antinodes.rows(), antinodes.cols()); p = Point(p.x + dx, p.y + dy)) {
+        antinodes.mark(p);
     }
-
     // 负方向
-    for (int i = 1;; i++)
-    {
-      Point p(antenna1.x - i * dx, antenna1.y - i * dy);
-      if (!isInBounds(p, rows, cols))
-        break;
-      antinodes.push_back(p);
+    for (Point p(antenna1.x - dx, antenna1.y - dy); isInBounds(p, antinodes.rows(), antinodes.cols());
+         p = Point(p.x - dx, p.y - dy)) {
+        antinodes.mark(p);
     }
-
-    return antinodes;
 }
 
-// 找到所有相同频率天线产生的反节点
-set<Point> findAntinodesForFrequency(const vector<Point>& antennas, int rows, int cols) {
-    set<Point> antinodes;
-    
+// 标记所有相同频率天线产生的反节点
+void findAntinodesForFrequency(const vector<Point>& antennas, AntinodeGrid& antinodes) {
     // 对于每对相同频率的天线，计算它们产生的反节点
     // 只保留在地图范围内的反节点
-    
     for (size_t i = 0; i < antennas.size(); i++) {
         for (size_t j = i + 1; j < antennas.size(); j++) {
-            vector<Point> nodesPair = calculateAntinodes(antennas[i], antennas[j]);
-            for (const Point& node : nodesPair) {
-                if (isInBounds(node, rows, cols)) {
-                    antinodes.insert(node);
-                }
-            }
+            markAntinodes(antennas[i], antennas[j], antinodes);
         }
     }
-    
-    return antinodes;
 }
 
-set<Point> findAntinodesForFrequencyPartTwo(const vector<Point>& antennas, int rows, int cols) {
-    set<Point> antinodes;
-
+void findAntinodesForFrequencyPartTwo(const vector<Point>& antennas, AntinodeGrid& antinodes) {
     for (size_t i = 0; i < antennas.size(); i++) {
         for (size_t j = i + 1; j < antennas.size(); j++) {
-            vector<Point> nodesPair = calculateAntinodesPartTwo(antennas[i], antennas[j], rows, cols);
-            for (const Point& node : nodesPair) {
-                if (isInBounds(node, rows, cols)) {
-                    antinodes.insert(node);
-                }
-            }
+            markAntinodesPartTwo(antennas[i], antennas[j], antinodes);
         }
     }
+}
 
-    return antinodes;
+// 带反节点的地图 (#表示反节点), 整帧一次性输出
+void renderAntinodes(const vector<string>& grid, const AntinodeGrid& antinodes) {
+    frame_buffer frame(antinodes.rows(), antinodes.cols());
+    for (int i = 0; i < antinodes.rows(); i++) {
+        frame.set_row(i, grid[i]);
+        for (int j = 0; j < antinodes.cols(); j++) {
+            if (antinodes.test(i, j) && grid[i][j] == '.') {
+                frame.at(i, j) = '#';
+            }
+        }
+    }
+    frame.write();
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // 用法: main [--render]
+    const bool render = render_requested(argc, argv);
+
     ifstream inputFile("input.txt");
     if (!inputFile.is_open()) {
         cerr << "错误：无法打开 input.txt 文件" << endl;
@@ -156,7 +189,8 @@ int main() {
     cout << "找到 " << antennasByFreq.size() << " 种不同频率的天线:" << endl;
     
     // 收集所有反节点
-    set<Point> allAntinodes;
+    AntinodeGrid allAntinodes(rows, cols);
+    AntinodeGrid freqAntinodes(rows, cols);
     
     for (const auto& pair : antennasByFreq) {
         char freq = pair.first;
@@ -166,53 +200,37 @@ int main() {
             continue;  // 需要至少两个天线才能产生反节点
         }
         
-        set<Point> freqAntinodes = findAntinodesForFrequency(antennas, rows, cols);
-        cout << "频率 '" << freq << "' 产生 " << freqAntinodes.size() << " 个反节点" << endl;
+        freqAntinodes.clear();
+        findAntinodesForFrequency(antennas, freqAntinodes);
+        cout << "频率 '" << freq << "' 产生 " << freqAntinodes.count() << " 个反节点" << endl;
         
-        // 合并到总集合中
-        allAntinodes.insert(freqAntinodes.begin(), freqAntinodes.end());
+        // 合并到总位图中
+        allAntinodes.merge(freqAntinodes);
     }
     
-    cout << "\n地图范围内总反节点数量: " << allAntinodes.size() << endl;
+    cout << "\n地图范围内总反节点数量: " << allAntinodes.count() << endl;
     
     // 打印带反节点的地图用于调试
-    cout << "\n带反节点的地图 (#表示反节点):" << endl;
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            Point current(i, j);
-            if (allAntinodes.count(current) && grid[i][j] == '.') {
-                cout << '#';
-            } else {
-                cout << grid[i][j];
-            }
-        }
-        cout << endl;
+    if (render) {
+        cout << "\n带反节点的地图 (#表示反节点):" << endl;
+        renderAntinodes(grid, allAntinodes);
     }
 
     /* Part 2 */
-    set<Point> allAntinodes2;
+    AntinodeGrid allAntinodes2(rows, cols);
     for (const auto& pair : antennasByFreq) {
         char freq = pair.first;
         const vector<Point>& antennas = pair.second;
         if (antennas.size() < 2) {
             continue;  // 需要至少两个天线才能产生反节点
         }
-        set<Point> freqAntinodes = findAntinodesForFrequencyPartTwo(antennas, rows, cols);
-        // 合并到总集合中
-        allAntinodes2.insert(freqAntinodes.begin(), freqAntinodes.end());
+        // 直接标记到总位图中
+        findAntinodesForFrequencyPartTwo(antennas, allAntinodes2);
     }
-    cout << "\nPart 2 - 地图范围内总反节点数量: " << allAntinodes2.size() << endl;
-    cout << "\nPart 2 - 带反节点的地图 (#表示反节点):" << endl;
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            Point current(i, j);
-            if (allAntinodes2.count(current) && grid[i][j] == '.') {
-                cout << '#';
-            } else {
-                cout << grid[i][j];
-            }
-        }
-        cout << endl;
+    cout << "\nPart 2 - 地图范围内总反节点数量: " << allAntinodes2.count() << endl;
+    if (render) {
+        cout << "\nPart 2 - 带反节点的地图 (#表示反节点):" << endl;
+        renderAntinodes(grid, allAntinodes2);
     }
     
     return 0;
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <queue>
+#include <functional>
 
 using namespace std;
 
@@ -17,134 +19,142 @@ string readInput(const string &filename)
   return "";
 }
 
-vector<int> parseDiskMap(const string &input)
+// 游程表示: 一段连续的块 [start, start + length)
+struct Span
 {
-  vector<int> disk;
-  for (size_t i = 0; i < input.size(); i += 2)
-  {
-    int block = input[i] - '0';
-    for (int j = 0; j < block; j++)
-    {
-      disk.push_back(i / 2);
-    }
-    int space = input[i + 1] - '0';
-    for (int j = 0; j < space; j++)
-    {
-      disk.push_back(-1); // -1 表示空闲块
-    }
-  }
-  return disk;
-}
+  int fileId; // -1 表示空闲
+  long long start;
+  int length;
+};
 
-long long calculateChecksum(const vector<int> &disk)
+// 解析为文件段和空闲段, 不展开成逐块数组, 空间为 O(数字个数)
+void parseRunLengths(const string &input, vector<Span> &files, vector<Span> &freeSpans)
 {
-  long long checksum = 0;
-  for (size_t i = 0; i < disk.size(); i++)
+  long long position = 0;
+  for (size_t i = 0; i < input.size(); i++)
   {
-    if (disk[i] == -1)
+    if (input[i] < '0' || input[i] > '9')
       continue;
-    checksum += i * disk[i];
+    int length = input[i] - '0';
+    if (i % 2 == 0)
+      files.push_back({static_cast<int>(i / 2), position, length});
+    else if (length > 0 && !freeSpans.empty() && freeSpans.back().start + freeSpans.back().length == position)
+      freeSpans.back().length += length; // 中间隔着长度为 0 的文件, 与前一个空闲段相连
+    else if (length > 0)
+      freeSpans.push_back({-1, position, length});
+    position += length;
   }
-  return checksum;
 }
 
-// Part 1: 压缩磁盘（逐个块移动）
-vector<int> compactDiskBlocks(vector<int> disk)
+// 一个文件段的校验和: id * (start + ... + start + length - 1), 按等差数列求和
+long long spanChecksum(long long fileId, long long start, long long length)
 {
-  int left = 0;
-  int right = disk.size() - 1;
-  while (right >= left)
-  {
-    if (disk[right] == -1)
-      right--;
-    else if (disk[left] != -1)
-      left++;
-    else if (disk[left] == -1 && disk[right] != -1)
-    {
-      swap(disk[left], disk[right]);
-      left++;
-    }
-    else
-      right--;
-  }
-  return disk;
+  return fileId * (start * length + length * (length - 1) / 2);
 }
 
 // Part 2: 压缩磁盘（整个文件移动）
-vector<int> compactDiskFiles(vector<int> disk)
+// 空闲段按长度 (1~9) 分到以起始位置为键的小根堆中
+// 对每个文件只需查看长度 >= 文件大小的各个堆顶, 取其中最靠左的一个, 每次移动 O(log n)
+long long compactFilesChecksum(const string &input)
 {
-  int maxFileId = 0;
-  for (int block : disk)
+  vector<Span> files;
+  vector<Span> freeSpans;
+  parseRunLengths(input, files, freeSpans);
+
+  // 长度为 0 的文件两侧的空闲段会合并, 所以长度可能超过 9
+  int maxLength = 9;
+  for (const auto &span : freeSpans)
   {
-    if (block != -1)
-    {
-      maxFileId = max(maxFileId, block);
-    }
+    maxLength = max(maxLength, span.length);
+  }
+  vector<priority_queue<long long, vector<long long>, greater<long long>>> freeByLength(maxLength + 1);
+  for (const auto &span : freeSpans)
+  {
+    freeByLength[span.length].push(span.start);
   }
 
-  for (int fileId = maxFileId; fileId >= 0; fileId--)
+  long long checksum = 0;
+  for (auto it = files.rbegin(); it != files.rend(); ++it)
   {
-    int fileStart = -1, fileSize = 0;
-    for (int i = 0; i < disk.size(); i++)
+    Span &file = *it;
+    int bestLength = 0;
+    long long bestStart = file.start;
+    for (int length = max(file.length, 1); length <= maxLength; length++)
     {
-      if (disk[i] == fileId)
+      if (!freeByLength[length].empty() && freeByLength[length].top() < bestStart)
       {
-        if (fileStart == -1)
-          fileStart = i;
-        fileSize++;
+        bestStart = freeByLength[length].top();
+        bestLength = length;
       }
     }
 
-    if (fileStart == -1)
-      continue;
-
-    int freeStart = -1;
-    int currentFreeSize = 0;
-
-    for (int i = 0; i < fileStart; i++)
+    if (bestLength > 0 && file.length > 0)
     {
-      if (disk[i] == -1)
+      freeByLength[bestLength].pop();
+      file.start = bestStart;
+      int remaining = bestLength - file.length;
+      if (remaining > 0)
       {
-        if (freeStart == -1)
-          freeStart = i;
-        currentFreeSize++;
-
-        if (currentFreeSize >= fileSize)
-        {
-          for (int j = 0; j < fileSize; j++)
-          {
-            disk[freeStart + j] = fileId;
-            disk[fileStart + j] = -1;
-          }
-          break;
-        }
-      }
-      else
-      {
-        freeStart = -1;
-        currentFreeSize = 0;
+        freeByLength[remaining].push(bestStart + file.length);
       }
     }
+    checksum += spanChecksum(file.fileId, file.start, file.length);
   }
-
-  return disk;
+  return checksum;
 }
 
-// 打印磁盘状态（调试用）
-void printDisk(const vector<int> &disk)
+// Part 1: 压缩磁盘（逐个块移动）
+// 两个游标直接在游程上移动: 左游标按顺序走过文件段和空闲段, 右游标从最后一个文件开始取块填入空闲段
+// 每一段用等差数列求和计算校验和, 不展开成逐块数组, 空间为 O(数字个数)
+long long compactBlocksChecksum(const string &input)
 {
-  for (const auto &block : disk)
+  vector<int> lengths;
+  for (char ch : input)
   {
-    if (block == -1)
+    if (ch >= '0' && ch <= '9')
+      lengths.push_back(ch - '0');
+  }
+  if (lengths.empty())
+    return 0;
+
+  long long checksum = 0;
+  long long position = 0;
+  int right = (lengths.size() - 1) / 2; // 右游标: 尚未移动完的最后一个文件
+  int rightRemaining = lengths[right * 2];
+  for (size_t k = 0; k < lengths.size(); k++)
+  {
+    const int left = k / 2;
+    if (k % 2 == 0)
     {
-      cout << ". ";
+      // 文件段: 右游标追上来时只剩下未被移走的部分
+      if (left > right)
+        break;
+      const int count = left == right ? rightRemaining : lengths[k];
+      checksum += spanChecksum(left, position, count);
+      position += count;
+      if (left == right)
+        break;
     }
     else
     {
-      cout << block << " ";
+      // 空闲段: 用右侧文件的块依次填满
+      int freeLength = lengths[k];
+      while (freeLength > 0 && right > left)
+      {
+        const int take = min(freeLength, rightRemaining);
+        checksum += spanChecksum(right, position, take);
+        position += take;
+        freeLength -= take;
+        rightRemaining -= take;
+        if (rightRemaining == 0)
+        {
+          right--;
+          rightRemaining = lengths[right * 2];
+        }
+      }
     }
   }
-  cout << endl;
+  return checksum;
 }
 
 int main()
@@ -156,18 +166,12 @@ int main()
     cout << "无法读取输入文件" << endl;
     return 1;
   }
-  // 解析磁盘映射
-  vector<int> originalDisk = parseDiskMap(input);
-  // printDisk(originalDisk);
-
-  // Part 1: 块级压缩
-  vector<int> diskPart1 = compactDiskBlocks(originalDisk);
-  long long result1 = calculateChecksum(diskPart1);
+  // Part 1: 块级压缩 (游程表示, 不展开磁盘)
+  long long result1 = compactBlocksChecksum(input);
   cout << "Part 1 结果: " << result1 << endl;
 
-  // Part 2: 文件级压缩
-  vector<int> diskPart2 = compactDiskFiles(originalDisk);
-  long long result2 = calculateChecksum(diskPart2);
+  // Part 2: 文件级压缩 (游程表示, 不展开磁盘)
+  long long result2 = compactFilesChecksum(input);
   cout << "Part 2 结果: " << result2 << endl;
 
   return 0;
@@ -2,7 +2,15 @@
 #include <fstream>
 #include <string>
 #include <vector>
-#include <set>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <bit>
+#include <random>
+#include "../../include/bench.hpp"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -18,109 +26,311 @@ vector<string> readInput(const string &filename)
   return grid;
 }
 
-/* Part 1 */
-set<pair<int, int>> dfs(const vector<string> &grid, int x, int y)
+/* 地形图的扁平表示: height[r * cols + c], 非数字格子为 -1 */
+struct TopoMap
 {
-  /* 1. 检查边界 */
-  if (x < 0 || x >= grid.size() || y < 0 || y >= grid[0].size())
-    return {};
-
-  /* 2. 检查是否为终点 */
-  if (grid[x][y] == '9')
-    return {{x, y}};
+  int rows = 0;
+  int cols = 0;
+  vector<int8_t> height;
+  array<vector<int>, 10> cellsByHeight; // 每一层高度的格子列表
+};
 
-  set<pair<int, int>> result;
-  const int dx[] = {-1, 1, 0, 0};
-  const int dy[] = {0, 0, -1, 1};
-
-  /* 3. 深度优先搜索四个方向 */
-  for (int i = 0; i < 4; i++)
+TopoMap buildTopoMap(const vector<string> &grid)
+{
+  TopoMap map;
+  map.rows = grid.size();
+  for (const auto &line : grid)
+    map.cols = max(map.cols, static_cast<int>(line.size()));
+  map.height.assign(static_cast<size_t>(map.rows) * map.cols, -1);
+  for (int r = 0; r < map.rows; ++r)
   {
-    int nx = x + dx[i], ny = y + dy[i];
-    if (nx >= 0 && nx < grid.size() && ny >= 0 && ny < grid[0].size() &&
-        grid[nx][ny] == grid[x][y] + 1)
+    for (int c = 0; c < static_cast<int>(grid[r].size()); ++c)
     {
-      auto reachable = dfs(grid, nx, ny);
-      result.insert(reachable.begin(), reachable.end());
+      char ch = grid[r][c];
+      if (ch >= '0' && ch <= '9')
+      {
+        const int cell = r * map.cols + c;
+        map.height[cell] = ch - '0';
+        map.cellsByHeight[ch - '0'].push_back(cell);
+      }
     }
   }
-  return result;
+  return map;
 }
 
-int findTrailheads(const vector<string> &grid)
+/* 对 cell 的每个高度恰好高 1 的相邻格子调用 fn */
+template <typename Fn>
+void forEachUphill(const TopoMap &map, int cell, Fn fn)
 {
-  int totalScore = 0;
-  /* 1. 遍历网格 */
-  for (int i = 0; i < grid.size(); ++i)
+  const int r = cell / map.cols, c = cell % map.cols;
+  const int next = map.height[cell] + 1;
+  if (r > 0 && map.height[cell - map.cols] == next)
+    fn(cell - map.cols);
+  if (r + 1 < map.rows && map.height[cell + map.cols] == next)
+    fn(cell + map.cols);
+  if (c > 0 && map.height[cell - 1] == next)
+    fn(cell - 1);
+  if (c + 1 < map.cols && map.height[cell + 1] == next)
+    fn(cell + 1);
+}
+
+/* Part 1 */
+/* 每个起点单独做一次 BFS, 访问标记用代数 (epoch) 区分, 起点之间无需清空 */
+long long findTrailheadsBfs(const TopoMap &map)
+{
+  vector<uint32_t> visited(map.height.size(), 0);
+  uint32_t epoch = 0;
+  vector<int> frontier, nextFrontier;
+  long long totalScore = 0;
+
+  for (int start : map.cellsByHeight[0])
   {
-    for (int j = 0; j < grid[i].size(); ++j)
+    ++epoch;
+    visited[start] = epoch;
+    frontier.assign(1, start);
+    /* 按高度逐层推进, 第 9 层的格子数就是得分 */
+    for (int h = 0; h < 9 && !frontier.empty(); ++h)
     {
-      /* 2. 检查是否为起点 */
-      char cell = grid[i][j];
-      if (cell == '0')
+      nextFrontier.clear();
+      for (int cell : frontier)
       {
-        /* 3. 计算得分 */
-        totalScore += dfs(grid, i, j).size();
+        forEachUphill(map, cell, [&](int next) {
+          if (visited[next] != epoch)
+          {
+            visited[next] = epoch;
+            nextFrontier.push_back(next);
+          }
+        });
       }
+      swap(frontier, nextFrontier);
     }
+    totalScore += frontier.size();
   }
   return totalScore;
 }
-/* Part 2 */
-int dfsRating(const vector<string> &grid, int x, int y)
+
+/* 可达山顶位集占用内存的上限 (字节), 也是 BFS 访问标记数组允许的最大内存 */
+const size_t reachBudgetBytes = 64 << 20;
+
+/* dst |= src, 共 words 个 64 位字 */
+inline void orWords(uint64_t *dst, const uint64_t *src, size_t words)
 {
-  /* 1. 检查边界 */
-  if (x < 0 || x >= grid.size() || y < 0 || y >= grid[0].size())
-    return 0;
+  size_t w = 0;
+#ifdef __AVX2__
+  for (; w + 4 <= words; w += 4)
+  {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + w));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + w));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + w), _mm256_or_si256(a, b));
+  }
+#endif
+  for (; w < words; ++w)
+    dst[w] |= src[w];
+}
+
+/* 地图按 reachTileSide 见方分块, 每次只给一块中的山顶编号; 山路只有 9 步, */
+/* 能到达这些山顶的格子都在块向外扩 9 格的范围内, 所以位集的大小与地图大小无关 */
+const int reachTileSide = 64;
+const int trailSteps = 9;
 
-  /* 2. 检查是否为终点 */
-  if (grid[x][y] == '9')
-    return 1;
+/* 在各块之间复用的缓冲区, 范围外补一圈空格子, 找相邻格子时不用判断边界 */
+struct ReachScratch
+{
+  array<vector<int>, 10> cells; // 范围内各层参与计算的格子 (局部下标), 第 9 层只有块内的山顶
+  vector<int8_t> height;        // 局部高度, 不参与计算为 -1
+  vector<uint8_t> mark;         // 剪枝用的标记
+  vector<int> index;            // 格子在所在层中的编号, 山顶的编号即其位集中的位
+  vector<uint64_t> upper, lower;
+};
 
-  int rating = 0;
-  const int dx[] = {-1, 1, 0, 0};
-  const int dy[] = {0, 0, -1, 1};
+/* 所有起点能到达的、位于以 (tileRow, tileCol) 为左上角的块内的山顶数之和 */
+/* 每个格子保存一个可达山顶位集, 从第 9 层往下逐层按位或, 只保留相邻两层的位集; */
+/* 块内山顶太多时按每批 64·k 个分批处理, 位集占用的内存不超过 budgetBytes */
+long long tileScore(const TopoMap &map, int tileRow, int tileCol, size_t budgetBytes, ReachScratch &scratch)
+{
+  const int top = max(0, tileRow - trailSteps), bottom = min(map.rows, tileRow + reachTileSide + trailSteps);
+  const int left = max(0, tileCol - trailSteps), right = min(map.cols, tileCol + reachTileSide + trailSteps);
+  const int width = right - left + 2;
+  const size_t area = static_cast<size_t>(bottom - top + 2) * width;
+  const int steps[] = { -width, width, -1, 1 };
 
-  /* 3. 深度优先搜索四个方向 */
-  for (int i = 0; i < 4; i++)
+  for (auto &layer : scratch.cells)
+    layer.clear();
+  scratch.height.assign(area, -1);
+  scratch.mark.assign(area, 0);
+  scratch.index.resize(area);
+  for (int r = top; r < bottom; ++r)
   {
-    int nx = x + dx[i], ny = y + dy[i];
-    if (nx >= 0 && nx < grid.size() && ny >= 0 && ny < grid[0].size() &&
-        grid[nx][ny] == grid[x][y] + 1)
+    for (int c = left; c < right; ++c)
     {
-      rating += dfsRating(grid, nx, ny);
+      const int h = map.height[r * map.cols + c];
+      if (h < 0 ||
+          (h == 9 && (r < tileRow || r >= tileRow + reachTileSide || c < tileCol || c >= tileCol + reachTileSide)))
+        continue;
+      const int local = (r - top + 1) * width + (c - left + 1);
+      scratch.height[local] = h;
+      scratch.cells[h].push_back(local);
     }
   }
-  
-  return rating;
-}
 
-int findTrailRatings(const vector<string> &grid)
-{
+  /* 剪枝: 只留下落在某条完整山路 (0 -> 9) 上的格子 */
+  /* 范围外的起点走不到块内的山顶, 所以只看范围内即可: 先往上标记能从起点走到的格子, 再往下留下能走到山顶的 */
+  enum : uint8_t { FROM_TRAILHEAD = 1, ON_TRAIL = 2 };
+  auto hasNeighbor = [&](int local, int h, uint8_t mark) {
+    bool found = false; // 不提前返回: 随机地形上分支几乎无法预测
+    for (int step : steps)
+      found |= (scratch.height[local + step] == h) & (scratch.mark[local + step] >= mark);
+    return found;
+  };
+  for (int local : scratch.cells[0])
+    scratch.mark[local] = FROM_TRAILHEAD;
+  for (int h = 1; h <= 9; ++h)
+    for (int local : scratch.cells[h])
+      scratch.mark[local] = hasNeighbor(local, h - 1, FROM_TRAILHEAD) ? FROM_TRAILHEAD : 0;
+  for (int h = 9; h >= 0; --h)
+  {
+    vector<int> &layer = scratch.cells[h];
+    size_t kept = 0;
+    for (int local : layer)
+    {
+      const bool keep = scratch.mark[local] && (h == 9 || hasNeighbor(local, h + 1, ON_TRAIL));
+      scratch.mark[local] = keep ? ON_TRAIL : 0;
+      scratch.height[local] = keep ? h : -1;
+      scratch.index[local] = kept;
+      layer[kept] = local;
+      kept += keep;
+    }
+    layer.resize(kept);
+  }
 
-  int total = 0;
-  for (size_t i = 0; i < grid.size(); i++)
+  const size_t summitCount = scratch.cells[9].size();
+  const size_t summitWords = (summitCount + 63) / 64;
+  if (summitWords == 0)
+    return 0;
+  size_t widestPair = 1;
+  for (int h = 0; h < 9; ++h)
+    widestPair = max(widestPair, scratch.cells[h].size() + scratch.cells[h + 1].size());
+  const size_t words = clamp<size_t>(budgetBytes / (widestPair * sizeof(uint64_t)), 1, summitWords);
+
+  vector<uint64_t> &upper = scratch.upper, &lower = scratch.lower;
+  long long score = 0;
+  for (size_t firstWord = 0; firstWord < summitWords; firstWord += words)
   {
-    for (size_t j = 0; j < grid[i].size(); j++)
+    const size_t batchWords = min(words, summitWords - firstWord);
+    const size_t firstSummit = firstWord * 64;
+    const size_t lastSummit = min(summitCount, (firstWord + batchWords) * 64);
+
+    /* 第 9 层: 本批中的每个山顶只可达它自己 */
+    upper.assign(summitCount * batchWords, 0);
+    for (size_t id = firstSummit; id < lastSummit; ++id)
     {
-      if (grid[i][j] == '0')
+      const size_t bit = id - firstSummit;
+      upper[id * batchWords + bit / 64] |= 1ULL << (bit % 64);
+    }
+
+    for (int h = 8; h >= 0; --h)
+    {
+      const vector<int> &layer = scratch.cells[h];
+      lower.assign(layer.size() * batchWords, 0);
+      for (size_t i = 0; i < layer.size(); ++i)
       {
-        // Part 2 需要不同的DFS逻辑
-        total += dfsRating(grid, i, j);
+        for (int step : steps)
+        {
+          const int next = layer[i] + step;
+          if (scratch.height[next] == h + 1)
+            orWords(&lower[i * batchWords], &upper[scratch.index[next] * batchWords], batchWords);
+        }
       }
+      swap(upper, lower);
     }
+
+    /* 现在 upper 是第 0 层, 每个起点在本批中的得分是其位集中 1 的个数 */
+    for (uint64_t word : upper)
+      score += popcount(word);
   }
+  return score;
+}
+
+/* 每对 (起点, 山顶) 只在山顶所在的块中计数一次 */
+long long findTrailheadsTiled(const TopoMap &map, size_t budgetBytes = reachBudgetBytes)
+{
+  ReachScratch scratch;
+  long long totalScore = 0;
+  for (int tileRow = 0; tileRow < map.rows; tileRow += reachTileSide)
+    for (int tileCol = 0; tileCol < map.cols; tileCol += reachTileSide)
+      totalScore += tileScore(map, tileRow, tileCol, budgetBytes, scratch);
+  return totalScore;
+}
+
+/* 山路只有 9 步, 逐起点 BFS 的工作量本身有界, 实测在各种山顶密度下都比分块位集快 (--bench); */
+/* 但它的访问标记每格 4 字节, 地图大到超出内存上限时才改用内存固定的分块位集 */
+long long findTrailheads(const TopoMap &map)
+{
+  if (map.height.size() * sizeof(uint32_t) <= reachBudgetBytes)
+    return findTrailheadsBfs(map);
+  return findTrailheadsTiled(map);
+}
+
+/* Part 2 */
+/* 从高度 9 到 0 逐层动态规划: paths[cell] = 从 cell 出发到达任意高度 9 的不同路径数 */
+long long findTrailRatings(const TopoMap &map)
+{
+  vector<long long> paths(map.height.size(), 0);
+  for (int cell : map.cellsByHeight[9])
+    paths[cell] = 1;
+  for (int h = 8; h >= 0; --h)
+  {
+    for (int cell : map.cellsByHeight[h])
+    {
+      long long total = 0;
+      forEachUphill(map, cell, [&](int next) { total += paths[next]; });
+      paths[cell] = total;
+    }
+  }
+
+  long long total = 0;
+  for (int cell : map.cellsByHeight[0])
+    total += paths[cell];
   return total;
 }
 
-int main()
+/* 生成 side x side 的合成地图, 比较逐起点 BFS 与位集两种 Part 1 的耗时 */
+void runBenchmark(int side)
+{
+  mt19937 rng(2024);
+  uniform_int_distribution<int> noise(0, 5);
+  const int offsets[] = { 0, 0, 0, 1, -1, 5 };
+  vector<string> grid(side, string(side, '.'));
+  for (int r = 0; r < side; ++r)
+    for (int c = 0; c < side; ++c)
+      grid[r][c] = '0' + ((r + c + offsets[noise(rng)]) % 10 + 10) % 10;
+  TopoMap map = buildTopoMap(grid);
+
+  cout << side << " x " << side << ", " << map.cellsByHeight[9].size() << " summits" << endl;
+  long long score = 0;
+  const double bfsMs = measure_ms([&] { score = findTrailheadsBfs(map); }, 1);
+  cout << "BFS:    " << bfsMs << " ms, score " << score << endl;
+  const double bitsMs = measure_ms([&] { score = findTrailheadsTiled(map); }, 1);
+  cout << "bitset: " << bitsMs << " ms, score " << score << endl;
+}
+
+int main(int argc, char *argv[])
 {
+  // 用法: main [--bench [side]]
+  if (argc > 1 && string(argv[1]) == "--bench")
+  {
+    runBenchmark(argc > 2 ? stoi(argv[2]) : 1000);
+    return 0;
+  }
+
   vector<string> grid = readInput("input.txt");
 
-  int result1 = findTrailheads(grid);
+  TopoMap map = buildTopoMap(grid);
+
+  long long result1 = findTrailheads(map);
   cout << "Part 1: " << result1 << endl;
 
-  int result2 = findTrailRatings(grid);
+  long long result2 = findTrailRatings(map);
   cout << "Part 2: " << result2 << endl;
 
   return 0;
@@ -3,7 +3,8 @@
 #include <vector>
 #include <string>
 #include <sstream>
-#include <map>
+#include "../../include/digits.hpp"
+#include "../../include/flat_count_map.hpp"
 using namespace std;
 
 vector<long long> parseInput(const string &filename)
@@ -23,68 +24,78 @@ vector<long long> parseInput(const string &filename)
 }
 
 /* Part 1 */
-vector<long long> blink(long long stone)
+/* result of one blink: one or two stones in a fixed-size struct, iterable with range-for */
+struct BlinkResult
 {
-  vector<long long> result;
-  /* rule 1: 0 -> 1 */
-  if (stone == 0)
+  long long stones[2];
+  int count;
+
+  const long long *begin() const
+  {
+    return stones;
+  }
+  const long long *end() const
   {
-    result.push_back(1);
-    return result;
+    return stones + count;
   }
-  /* rule 2: split into 2 stone if even number of digits */
-  string stoneStr = to_string(stone);
-  if (stoneStr.size() % 2 == 0)
+};
+
+BlinkResult blink(long long stone)
+{
+  /* rule 1: 0 -> 1 */
+  if (stone == 0)
+    return {{1, 0}, 1};
+  /* rule 2: split into 2 stone if even number of digits, the halves are stone / 10^(n/2) and stone % 10^(n/2) */
+  const int digits = digit_count(stone);
+  if (digits % 2 == 0)
   {
-    string left = stoneStr.substr(0, stoneStr.size() / 2);
-    string right = stoneStr.substr(stoneStr.size() / 2);
-    long long leftNum = stoll(left);
-    long long rightNum = stoll(right);
-    result.push_back(leftNum);
-    result.push_back(rightNum);
-    return result;
+    const long long half = pow10[digits / 2];
+    return {{stone / half, stone % half}, 2};
   }
   /* rule 3: stone *= 2024 */
-  return {stone * 2024};
+  return {{stone * 2024, 0}, 1};
 }
 
-int solvePart1(vector<long long> stones, int blinking = 1)
+long long solvePart1(vector<long long> stones, int blinking = 1)
 {
+  vector<long long> newStones;
   for (int i = 0; i < blinking; ++i)
   {
-    vector<long long> newStones;
+    newStones.clear();
     for (auto stone : stones)
     {
-      auto blinked = blink(stone);
-      newStones.insert(newStones.end(), blinked.begin(), blinked.end());
+      for (long long next : blink(stone))
+        newStones.push_back(next);
     }
-    stones = newStones;
+    swap(stones, newStones);
   }
 
   return stones.size();
 }
 
 /* Part 2 */
-map<pair<long long, int>, long long> memo;
-long long solveStoneMemo(long long stone, int blinks)
-{
-  if (blinks == 0) return 1; // 一个石头
-  pair<long long, int> key = {stone, blinks};
-
-  if (memo.find(key) != memo.end()) return memo[key];
-  long long result = 0;
-  vector<long long> nextStones = blink(stone);
-
-  for (long long nextStone : nextStones) result += solveStoneMemo(nextStone, blinks - 1);
-
-  memo[key] = result;
-  return result;
-}
+/* 每次眨眼后的石头状态: 数值 -> 个数 (顺序无关, 相同数值的石头演化完全一样) */
+/* 扁平哈希表的内存只与不同数值的个数成正比 */
+using StoneCounts = flat_count_map<long long, long long>;
 
-long long solvePart2(vector<long long> stones, int blinking = 1)
+/* 两张表交替使用: 由 current 推出 next, 然后交换, 旧表清空但不释放内存 */
+long long solvePart2(const vector<long long> &stones, int blinking = 1)
 {
+  StoneCounts current, next;
+  for (auto stone : stones)
+    current.add(stone, 1);
+
+  for (int i = 0; i < blinking; ++i)
+  {
+    next.clear();
+    current.for_each([&](long long stone, long long count) {
+      for (long long nextStone : blink(stone))
+        next.add(nextStone, count);
+    });
+    swap(current, next);
+  }
   long long total = 0;
-  for (auto stone : stones) total += solveStoneMemo(stone, blinking);
+  current.for_each([&](long long, long long count) { total += count; });
   return total;
 }
 
@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include "../../include/render.hpp"
 
 const int WIDTH = 101; // 画布宽度
 const int HEIGHT = 103; // 画布高度
@@ -92,7 +93,7 @@ int Part1(const std::vector<Robot>& robots) {
  * 计算形成圣诞树形状的时刻，并返回该时刻
  * 题目没有给出具体的圣诞树形状定义，因此这里假设圣诞树必然会形成3*3的机器人集群作为判断条件
  */
-int Part2(const std::vector<Robot>& robots) {
+int Part2(const std::vector<Robot>& robots, bool render) {
     for (int t = 0; t < 10000; ++t) {
         std::vector<std::vector<bool>> canvas(HEIGHT, std::vector<bool>(WIDTH, false));
         for (const Robot& robot : robots) {
@@ -112,14 +113,19 @@ int Part2(const std::vector<Robot>& robots) {
                     canvas[y][x-1] && canvas[y][x+1] &&
                     canvas[y-1][x-1] && canvas[y-1][x+1] &&
                     canvas[y+1][x-1] && canvas[y+1][x+1]) {
-                    // 输出画布
+                    // 输出画布 (仅在 --render 时), 整帧一次性写出
                     std::cout << "---Part2---" << std::endl;
                     std::cout << "形成圣诞树形状的时刻: " << t << std::endl;
-                    for (int i = 0; i < HEIGHT; ++i) {
-                        for (int j = 0; j < WIDTH; ++j) {
-                            std::cout << (canvas[i][j] ? '#' : '.');
+                    if (render) {
+                        frame_buffer frame(HEIGHT, WIDTH);
+                        for (int i = 0; i < HEIGHT; ++i) {
+                            for (int j = 0; j < WIDTH; ++j) {
+                                if (canvas[i][j]) {
+                                    frame.at(i, j) = '#';
+                                }
+                            }
                         }
-                        std::cout << std::endl;
+                        frame.write();
                     }
                     return t; // 返回形成圣诞树形状的时刻
                 }
@@ -129,12 +135,14 @@ int Part2(const std::vector<Robot>& robots) {
     return -1; // 如果没有形成圣诞树形状，返回-1
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // 用法: main [--render]
+    const bool render = render_requested(argc, argv);
     std::string filename = "input.txt";
     std::vector<Robot> robots = readInput(filename);    
 
     int result1 = Part1(robots);
-    int result2 = Part2(robots);
+    int result2 = Part2(robots, render);
 
     std::cout << "Part 1: " << result1 << std::endl;
     std::cout << "Part 2: " << result2 << std::endl;
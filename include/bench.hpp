@@ -0,0 +1,23 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+/**
+ * 基准测试工具
+ * 多次运行 fn, 返回最快一次的耗时 (毫秒)
+ */
+template <typename fn_t>
+double measure_ms(fn_t &&fn, int repeats = 3)
+{
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeats; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto stop = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+  }
+  return best;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+
+/**
+ * 十进制位数工具
+ * 1. pow10[i] = 10^i, 覆盖 long long 的全部范围 (10^0 .. 10^18)
+ * 2. digit_count 无循环无分配地求十进制位数
+ */
+
+inline constexpr std::array<long long, 19> pow10 = [] {
+  std::array<long long, 19> table{};
+  table[0] = 1;
+  for (size_t i = 1; i < table.size(); ++i)
+  {
+    table[i] = table[i - 1] * 10;
+  }
+  return table;
+}();
+
+/**
+ * @brief 非负整数 x 的十进制位数, digit_count(0) == 1
+ * floor(log10(x)) 由二进制位数估算 (1233 / 4096 ≈ log10(2)), 估算值至多小 1, 再查表修正一次
+ */
+constexpr int digit_count(long long x)
+{
+  const auto v = static_cast<unsigned long long>(x) | 1;
+  const int approx = (std::bit_width(v) * 1233) >> 12;
+  return approx + (v >= static_cast<unsigned long long>(pow10[approx]) ? 1 : 0);
+}
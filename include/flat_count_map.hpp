@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 整数键 -> 计数 的扁平哈希表
+ * 1. 开放寻址 + 线性探测, 键和计数分别存放在两个连续数组中
+ * 2. Fibonacci 哈希, 相邻的键被分散到整张表
+ * 3. 计数为 0 表示空槽位, 所以只能累加正数
+ * 4. 负载超过 1/2 时容量翻倍; clear() 只清空槽位, 不释放内存, 适合反复填充
+ */
+template <typename key_t, typename count_t = uint64_t>
+  requires std::is_integral_v<key_t> && std::is_integral_v<count_t>
+class flat_count_map
+{
+  public:
+  explicit flat_count_map(size_t expected = 0)
+  {
+    rehash(std::max<size_t>(16, std::bit_ceil(expected * 2)));
+  }
+
+  void add(key_t key, count_t count = 1)
+  {
+    if ((m_size + 1) * 2 > m_keys.size())
+    {
+      rehash(m_keys.size() * 2);
+    }
+    size_t slot = bucket(key);
+    while (m_counts[slot] != 0 && m_keys[slot] != key)
+    {
+      slot = (slot + 1) & m_mask;
+    }
+    if (m_counts[slot] == 0)
+    {
+      m_keys[slot] = key;
+      ++m_size;
+    }
+    m_counts[slot] += count;
+  }
+
+  count_t count(key_t key) const
+  {
+    size_t slot = bucket(key);
+    while (m_counts[slot] != 0)
+    {
+      if (m_keys[slot] == key)
+      {
+        return m_counts[slot];
+      }
+      slot = (slot + 1) & m_mask;
+    }
+    return 0;
+  }
+
+  // 清空所有槽位, 保留已分配的容量
+  void clear()
+  {
+    std::fill(m_counts.begin(), m_counts.end(), count_t{ 0 });
+    m_size = 0;
+  }
+
+  // 按槽位顺序对每个 (键, 计数) 调用 fn, 顺序不确定
+  template <typename fn_t>
+  void for_each(fn_t &&fn) const
+  {
+    for (size_t slot = 0; slot < m_keys.size(); ++slot)
+    {
+      if (m_counts[slot] != 0)
+      {
+        fn(m_keys[slot], m_counts[slot]);
+      }
+    }
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  private:
+  size_t bucket(key_t key) const
+  {
+    return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> m_shift);
+  }
+
+  // 容量 (2 的幂) 调整为 capacity 并重新插入已有的键
+  void rehash(size_t capacity)
+  {
+    std::vector<key_t> keys = std::exchange(m_keys, std::vector<key_t>(capacity));
+    std::vector<count_t> counts = std::exchange(m_counts, std::vector<count_t>(capacity, 0));
+    m_mask = capacity - 1;
+    m_shift = 64 - std::countr_zero(capacity);
+    m_size = 0;
+    for (size_t slot = 0; slot < keys.size(); ++slot)
+    {
+      if (counts[slot] != 0)
+      {
+        add(keys[slot], counts[slot]);
+      }
+    }
+  }
+
+  size_t m_mask = 0;
+  int m_shift = 0; // 取乘积的高位作为槽位
+  size_t m_size = 0;
+  std::vector<key_t> m_keys;
+  std::vector<count_t> m_counts;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * 整数文本扫描工具
+ * 1. 一次性把整个文件读入连续缓冲区
+ * 2. 在缓冲区上逐行扫描以空白分隔的整数 (std::from_chars), 不产生任何临时字符串
+ */
+
+inline std::string read_file(const std::string &filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+/**
+ * @brief 按行扫描空白分隔整数的游标
+ * 用法:
+ *   int_scanner scanner(buffer);
+ *   do { while (scanner.next(value)) { ... } } while (scanner.next_line());
+ * @note 不拥有缓冲区, 缓冲区生命周期必须覆盖扫描过程
+ */
+class int_scanner
+{
+  public:
+  explicit int_scanner(std::string_view buffer) : m_pos(buffer.data()), m_end(buffer.data() + buffer.size())
+  {
+  }
+
+  // 读取当前行的下一个整数, 行尾或遇到非数字内容时返回 false
+  template <typename t_t>
+    requires std::is_integral_v<t_t>
+  bool next(t_t &value)
+  {
+    skip_blanks();
+    if (m_pos == m_end || *m_pos == '\n')
+    {
+      return false;
+    }
+    const auto [ptr, ec] = std::from_chars(m_pos, m_end, value);
+    if (ec != std::errc{})
+    {
+      return false;
+    }
+    m_pos = ptr;
+    return true;
+  }
+
+  // 跳到下一行开头, 已经没有下一行时返回 false
+  bool next_line()
+  {
+    while (m_pos != m_end && *m_pos != '\n')
+    {
+      ++m_pos;
+    }
+    if (m_pos == m_end)
+    {
+      return false;
+    }
+    ++m_pos;
+    return m_pos != m_end;
+  }
+
+  [[nodiscard]] bool at_end() const
+  {
+    return m_pos == m_end;
+  }
+
+  private:
+  void skip_blanks()
+  {
+    while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r'))
+    {
+      ++m_pos;
+    }
+  }
+
+  const char *m_pos;
+  const char *m_end;
+};
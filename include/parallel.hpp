@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * 简单的数据并行工具
+ * 1. 默认线程数
+ * 2. 按连续区间切分 [0, n) 并在多个线程上执行
+ * 3. 可复用的线程池
+ * 4. 有界阻塞队列 (生产者/消费者流水线)
+ */
+
+inline unsigned default_thread_count()
+{
+  unsigned n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+/**
+ * @brief 将 [0, n) 切分为 threads 个连续区间, 每个区间在独立线程上调用 fn(thread_index, begin, end)
+ * @note 相同的 n 和 threads 总是得到相同的切分, 方便多趟算法复用每个线程的局部结果
+ */
+template <typename fn_t>
+void parallel_for_chunks(size_t n, unsigned threads, fn_t &&fn)
+{
+  threads = std::max(1u, threads);
+  if (threads == 1 || n == 0)
+  {
+    fn(0u, size_t{ 0 }, n);
+    return;
+  }
+
+  const size_t chunk = (n + threads - 1) / threads;
+  std::vector<std::jthread> workers;
+  workers.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t)
+  {
+    const size_t begin = std::min(n, t * chunk);
+    const size_t end = std::min(n, begin + chunk);
+    workers.emplace_back([&fn, t, begin, end]() { fn(t, begin, end); });
+  }
+}
+
+/**
+ * 固定线程数的线程池
+ * 1. submit: 提交任务, 返回 std::future
+ * 2. for_chunks: 与 parallel_for_chunks 相同的切分方式, 但复用池中的线程, 适合被反复调用的批处理
+ */
+class thread_pool
+{
+  public:
+  explicit thread_pool(unsigned threads = default_thread_count())
+  {
+    threads = std::max(1u, threads);
+    m_workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t)
+    {
+      m_workers.emplace_back([this](std::stop_token stop) { work(stop); });
+    }
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  ~thread_pool()
+  {
+    for (auto &worker : m_workers)
+    {
+      worker.request_stop();
+    }
+    m_ready.notify_all();
+  }
+
+  [[nodiscard]] unsigned size() const
+  {
+    return static_cast<unsigned>(m_workers.size());
+  }
+
+  template <typename fn_t>
+  auto submit(fn_t &&fn) -> std::future<std::invoke_result_t<fn_t>>
+  {
+    auto task = std::make_shared<std::packaged_task<std::invoke_result_t<fn_t>()>>(std::forward<fn_t>(fn));
+    auto result = task->get_future();
+    {
+      std::lock_guard lock(m_mutex);
+      m_tasks.emplace_back([task]() { (*task)(); });
+    }
+    m_ready.notify_one();
+    return result;
+  }
+
+  /**
+   * @brief 将 [0, n) 切分为 chunks 个连续区间并在池中执行 fn(chunk_index, begin, end), 阻塞直到全部完成
+   */
+  template <typename fn_t>
+  void for_chunks(size_t n, unsigned chunks, fn_t &&fn)
+  {
+    chunks = std::max(1u, chunks);
+    const size_t chunk = (n + chunks - 1) / chunks;
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks);
+    for (unsigned c = 0; c < chunks; ++c)
+    {
+      const size_t begin = std::min(n, c * chunk);
+      const size_t end = std::min(n, begin + chunk);
+      pending.push_back(submit([&fn, c, begin, end]() { fn(c, begin, end); }));
+    }
+    for (auto &task : pending)
+    {
+      task.get();
+    }
+  }
+
+  private:
+  void work(const std::stop_token &stop)
+  {
+    while (true)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock lock(m_mutex);
+        m_ready.wait(lock, stop, [this]() { return !m_tasks.empty(); });
+        if (m_tasks.empty())
+        {
+          return; // 收到停止请求且没有剩余任务
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable_any m_ready;
+  std::deque<std::function<void()>> m_tasks;
+  std::vector<std::jthread> m_workers;
+};
+
+/**
+ * 有界阻塞队列
+ * push 在队列满时阻塞, pop 在队列空时阻塞; close 之后 pop 取完剩余元素返回 std::nullopt
+ * 容量限制了流水线中同时存在的元素个数, 从而限制内存占用
+ */
+template <typename t_t>
+class bounded_queue
+{
+  public:
+  explicit bounded_queue(size_t capacity) : m_capacity(std::max<size_t>(1, capacity))
+  {
+  }
+
+  void push(t_t value)
+  {
+    std::unique_lock lock(m_mutex);
+    m_not_full.wait(lock, [this]() { return m_items.size() < m_capacity; });
+    m_items.push_back(std::move(value));
+    m_not_empty.notify_one();
+  }
+
+  std::optional<t_t> pop()
+  {
+    std::unique_lock lock(m_mutex);
+    m_not_empty.wait(lock, [this]() { return !m_items.empty() || m_closed; });
+    if (m_items.empty())
+    {
+      return std::nullopt;
+    }
+    t_t value = std::move(m_items.front());
+    m_items.pop_front();
+    m_not_full.notify_one();
+    return value;
+  }
+
+  void close()
+  {
+    std::lock_guard lock(m_mutex);
+    m_closed = true;
+    m_not_empty.notify_all();
+  }
+
+  private:
+  size_t m_capacity;
+  bool m_closed = false;
+  std::mutex m_mutex;
+  std::condition_variable m_not_full;
+  std::condition_variable m_not_empty;
+  std::deque<t_t> m_items;
+};
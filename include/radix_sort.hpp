@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "parallel.hpp"
+
+/**
+ * 32 位 LSD 基数排序
+ * 1. 每趟处理 8 bit, 共 4 趟: 直方图 -> 前缀和 -> 稳定分发
+ * 2. 有符号整数翻转符号位后按无符号顺序排序
+ * 3. 某一位上所有元素都落在同一个桶时跳过该趟 (小范围 ID 只需 2~3 趟)
+ * 4. threads > 1 时每个线程统计自己区间的直方图, 分发阶段各线程按区间并行写入, 结果仍然稳定
+ * 时间 O(n), 额外空间 O(n), 不递归, 对已排序/逆序/大量重复的输入同样是线性的
+ */
+
+constexpr unsigned radix_sort_bits = 8;
+constexpr size_t radix_sort_buckets = size_t{ 1 } << radix_sort_bits;
+// 每个线程至少处理这么多元素, 否则线程开销大于收益
+constexpr size_t radix_sort_min_chunk = size_t{ 1 } << 16;
+
+template <typename t_t>
+  requires(std::is_integral_v<t_t> && sizeof(t_t) == 4)
+void radix_sort(std::span<t_t> data, unsigned threads = 1)
+{
+  const size_t n = data.size();
+  if (n < 2)
+  {
+    return;
+  }
+
+  const auto key = [](t_t value) {
+    auto k = static_cast<uint32_t>(value);
+    if constexpr (std::is_signed_v<t_t>)
+    {
+      k ^= 0x80000000u;
+    }
+    return k;
+  };
+
+  threads = static_cast<unsigned>(std::clamp<size_t>(n / radix_sort_min_chunk, 1, std::max(1u, threads)));
+
+  std::vector<t_t> buffer(n);
+  std::span<t_t> src = data;
+  std::span<t_t> dst = buffer;
+  std::vector<std::array<size_t, radix_sort_buckets>> histograms(threads);
+
+  for (unsigned shift = 0; shift < 32; shift += radix_sort_bits)
+  {
+    /* 1. 每个线程统计自己区间的直方图 */
+    parallel_for_chunks(n, threads, [&](unsigned t, size_t begin, size_t end) {
+      auto &hist = histograms[t];
+      hist.fill(0);
+      for (size_t i = begin; i < end; ++i)
+      {
+        ++hist[(key(src[i]) >> shift) & (radix_sort_buckets - 1)];
+      }
+    });
+
+    /* 2. 所有元素在该位相同则跳过 */
+    bool trivial = false;
+    for (size_t b = 0; b < radix_sort_buckets && !trivial; ++b)
+    {
+      size_t total = 0;
+      for (const auto &hist : histograms)
+      {
+        total += hist[b];
+      }
+      trivial = total == n;
+    }
+    if (trivial)
+    {
+      continue;
+    }
+
+    /* 3. 前缀和: 桶优先, 同一桶内按线程顺序, 保证稳定 */
+    size_t offset = 0;
+    for (size_t b = 0; b < radix_sort_buckets; ++b)
+    {
+      for (auto &hist : histograms)
+      {
+        const size_t count = hist[b];
+        hist[b] = offset;
+        offset += count;
+      }
+    }
+
+    /* 4. 分发 */
+    parallel_for_chunks(n, threads, [&](unsigned t, size_t begin, size_t end) {
+      auto &hist = histograms[t];
+      for (size_t i = begin; i < end; ++i)
+      {
+        dst[hist[(key(src[i]) >> shift) & (radix_sort_buckets - 1)]++] = src[i];
+      }
+    });
+    std::swap(src, dst);
+  }
+
+  if (src.data() != data.data())
+  {
+    std::memcpy(data.data(), src.data(), n * sizeof(t_t));
+  }
+}
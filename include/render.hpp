@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+/**
+ * 缓冲渲染工具
+ * 1. 整帧字符画写入一块连续缓冲区 (每行末尾带换行), 输出时只调用一次 fwrite
+ * 2. 渲染默认关闭, 命令行带 --render 时才打开, 避免终端 I/O 计入求解耗时
+ */
+
+inline bool render_requested(int argc, char *argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::string_view(argv[i]) == "--render")
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+class frame_buffer
+{
+  public:
+  frame_buffer(int rows, int cols, char fill = '.')
+      : m_cols(cols), m_buffer(static_cast<size_t>(rows) * (cols + 1), fill)
+  {
+    for (int r = 0; r < rows; ++r)
+    {
+      m_buffer[static_cast<size_t>(r) * (cols + 1) + cols] = '\n';
+    }
+  }
+
+  char &at(int row, int col)
+  {
+    return m_buffer[static_cast<size_t>(row) * (m_cols + 1) + col];
+  }
+
+  // 用一行文本覆盖第 row 行 (超出列数的部分被截断)
+  void set_row(int row, std::string_view text)
+  {
+    text = text.substr(0, m_cols);
+    text.copy(&at(row, 0), text.size());
+  }
+
+  void write(std::FILE *out = stdout) const
+  {
+    std::fflush(out);
+    std::fwrite(m_buffer.data(), 1, m_buffer.size(), out);
+    std::fflush(out);
+  }
+
+  private:
+  int m_cols;
+  std::string m_buffer;
+};